@@ -1,5 +1,6 @@
+#pragma once
 #include "ChessDefinitions.h"
-
+#include "MagicBitboard.h"
 
 namespace ChessEngine {
 
@@ -7,14 +8,66 @@ namespace ChessEngine {
 		u64 pawnAttack[2][64];
 		u64 kingAttack[64];
 		u64 knightAttack[64];
-		u64 rookAttack[64][4096];
-		u64 bishopAttack[64][512];
+		u64 sliders[SLIDER_TABLE_SIZE]; // bố cục sliderLayout, chỉ số magicIndex
+		u64 betweenSquares[64][64]; // Các ô nằm giữa 2 ô thẳng hàng (không gồm 2 đầu mút)
+		u64 lineSquares[64][64];    // Cả đường thẳng đi qua 2 ô thẳng hàng
 
-		AttackTable();
+		// constexpr: toàn bộ bảng được tính lúc biên dịch (AttackTable.cpp)
+		constexpr AttackTable();
 	};
 
-    extern AttackTable Attack;
-    void knightAttackTable(u64 (&KnightAttack)[64]);
-    void pawnAttackTable(u64 (&PawnAttack)[2][64]);
-    void kingAttackTable(u64 (&KingAttack)[64]);
+    // Nằm sẵn trong .rodata của file thực thi, không có bước khởi tạo lúc chạy
+    // nên dùng được cả trong khởi tạo tĩnh của các file khác
+    extern const AttackTable Attack;
+
+    enum class SliderBackend { Magic, Pext };
+
+    // Điểm chọn backend duy nhất: các con trỏ hàm được gán một lần lúc khởi
+    // động theo CPUID (AttackTable.cpp), mỗi lần tra không phải rẽ nhánh. Giá
+    // trị tĩnh ban đầu là magic nên tra cứu trong khởi tạo tĩnh của các file
+    // khác (trước khi chọn) vẫn đúng.
+    struct SliderLookup {
+        u64 (*rook)(ui square, u64 occupancy);
+        u64 (*bishop)(ui square, u64 occupancy);
+        SliderBackend backend;
+    };
+
+    extern SliderLookup sliderLookup;
+
+    // PEXT khi CPU có BMI2 nhanh (AMD trước Zen 3 chạy PEXT bằng microcode)
+    SliderBackend detectSliderBackend();
+    const char *sliderBackendName(SliderBackend backend);
+
+    // Đối chiếu và đo thời gian tra cứu xe/tượng với occupancy ngẫu nhiên cho
+    // từng backend mà CPU chạy được
+    void runSliderBench(std::ostream &out = std::cout);
+
+    // Tra cứu magic trên bảng dựng sẵn lúc biên dịch (backend dự phòng)
+    inline u64 magicRookAttacks(ui square, u64 occupancy)
+    {
+        return Attack.sliders[sliderLayout.rookOffset[square]
+            + magicIndex(occupancy, rookMask[square], rookMagic[square], rookShift[square])];
+    }
+
+    inline u64 magicBishopAttacks(ui square, u64 occupancy)
+    {
+        return Attack.sliders[sliderLayout.bishopOffset[square]
+            + magicIndex(occupancy, bishopMask[square], bishopMagic[square], bishopShift[square])];
+    }
+
+    // Lookups used by the move generator and search
+    inline u64 rookAttacks(ui square, u64 occupancy)
+    {
+        return sliderLookup.rook(square, occupancy);
+    }
+
+    inline u64 bishopAttacks(ui square, u64 occupancy)
+    {
+        return sliderLookup.bishop(square, occupancy);
+    }
+
+    inline u64 queenAttacks(ui square, u64 occupancy)
+    {
+        return rookAttacks(square, occupancy) | bishopAttacks(square, occupancy);
+    }
 }
@@ -0,0 +1,41 @@
+#pragma once
+#include "Search.h"
+#include <iostream>
+
+// Phân tích hàng loạt: đọc luồng EPD/FEN (mỗi dòng một thế, như myGame.txt)
+// hoặc PGN (mỗi thế trước một nước đã đi), chia cho nhiều luồng và ghi kết
+// quả JSONL đúng thứ tự đầu vào.
+
+namespace ChessEngine {
+
+	struct BatchOptions {
+		SearchLimits limits; // depth / nodes cho mỗi thế
+		int threads = 1;
+		// Số thế tối đa đã đọc mà chưa ghi ra (đang chờ, đang tìm hoặc chờ
+		// tới lượt ghi); giới hạn bộ nhớ cho đầu vào dài tùy ý. 0 = 64 * threads
+		size_t window = 0;
+	};
+
+	struct BatchReport {
+		u64 positions = 0; // kể cả dòng lỗi
+		u64 errors = 0;
+		u64 nodes = 0;
+		double seconds = 0;
+
+		// Theo từng luồng: số thế đã phân tích, thời gian tìm kiếm thực, số thế lấy trộm
+		std::vector<u64> workerPositions;
+		std::vector<double> workerBusy;
+		std::vector<u64> workerSteals;
+
+		double positionsPerSecond() const { return seconds > 0 ? positions / seconds : 0.0; }
+		// Tổng thời gian làm việc của các luồng / thời gian thực
+		double scaling() const;
+	};
+
+	// Đọc in tới hết, ghi mỗi thế một dòng JSON ra out. Định dạng tự nhận theo
+	// dòng có nội dung đầu tiên: '[' là PGN, còn lại là EPD/FEN.
+	// Các luồng dùng chung TT (gọi TT.resize trước nếu cần).
+	BatchReport runBatch(std::istream &in, std::ostream &out, const BatchOptions &options);
+
+	void printBatchReport(const BatchReport &report, std::ostream &out = std::cerr);
+}
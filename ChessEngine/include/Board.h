@@ -1,6 +1,8 @@
 ﻿#pragma once
 #include "ChessDefinitions.h"
 #include "ZobristHash.h"
+#include "NNUE.h"
+#include <type_traits>
 
 constexpr int piecesNum = 12;
 
@@ -13,62 +15,127 @@ namespace ChessEngine
 		bool whiteTurn;
 		std::string castling;
 		std::string enPassant;
-		int halfMove;
-		int fullMove;
+		int halfMove = 0; // FEN rút gọn (thiếu hai trường cuối) vẫn hợp lệ
+		int fullMove = 1;
 		Fen(const std::string &FEN);
 	};
 
+	// Nước đi nén 16 bit: 6 bit from, 6 bit to, 4 bit mã MoveFlag (kèm quân phong cấp)
 	struct Move
 	{
-		ui from;	  // ô bắt đầu
-		ui to;		  // ô kết thúc
-		ui promotion; // loại quân khi phong cấp (0 = none)
-		ui flags;	  // bit flags: capture, en passant, castling, ...
+		constexpr Move() : data(0) {}
 
-		Move()
-			: from(0), to(0), promotion(promoNone), flags(quiet)
+		constexpr Move(ui fromSq, ui toSq, ui moveFlags = quiet, ui promo = promoNone)
+			: data(uint16_t(fromSq | (toSq << 6)
+				| ((moveFlags | (promo != promoNone ? promo - promoKnight : 0)) << 12)))
 		{
 		}
 
-		Move(ui fromSq, ui toSq, ui moveFlags = quiet, ui promo = promoNone)
-			: from(fromSq), to(toSq), promotion(promo), flags(moveFlags)
+		static constexpr Move fromRaw(uint16_t raw)
 		{
+			Move move;
+			move.data = raw;
+			return move;
 		}
+
+		constexpr ui from() const { return data & 63; }
+		constexpr ui to() const { return (data >> 6) & 63; }
+		constexpr ui flags() const { return data >> 12; }
+		constexpr uint16_t raw() const { return data; }
+
+		constexpr bool isCapture() const { return flags() & capture; }
+		constexpr bool isPromotion() const { return flags() & promotion; }
+		constexpr bool isEnPassant() const { return flags() == enPassant; }
+		constexpr bool isCastling() const { return flags() == castling; }
+		constexpr bool isDoublePush() const { return flags() == doublePush; }
+		// Loại quân phong cấp (promoKnight..promoQueen), chỉ có nghĩa khi isPromotion()
+		constexpr ui promotionType() const { return (flags() & 3) + promoKnight; }
+
+		// Move() mặc định (a1a1) dùng làm "không có nước"
+		constexpr bool isNone() const { return from() == to(); }
+		constexpr bool operator==(const Move &other) const { return data == other.data; }
+
+	private:
+		uint16_t data;
 	};
 
-	struct MoveList //Danh sách nước 
+	// Nước đi kèm điểm sắp xếp 16 bit (4 byte), phần tử của MoveList
+	struct ExtMove : Move
 	{
-		Move *begin() { return moves; }
-		Move *end() { return moves + size; }
+		int16_t score;
+	};
 
-		void push(Move m) { moves[size++] = m; }
+	// Ký hiệu UCI của nước đi, ví dụ "e2e4", "e7e8q"
+	std::string moveToString(const Move &move);
+
+	struct MoveList //Danh sách nước (1 KB: 256 x ExtMove 4 byte)
+	{
+		ExtMove *begin() { return moves; }
+		ExtMove *end() { return moves + size; }
+
+		const ExtMove *begin() const { return moves; }
+		const ExtMove *end() const { return moves + size; }
+
+		void push(Move m) { moves[size++] = ExtMove{ m, 0 }; }
+		void clear() { size = 0; }
+		int count() const { return size; }
+		ExtMove &operator[](int i) { return moves[i]; }
+		const ExtMove &operator[](int i) const { return moves[i]; }
 
 	private:
-		Move moves[MAX_MOVES];
+		ExtMove moves[MAX_MOVES];
 		int size = 0;
 	};
 
-	struct StateInfo
+	// Thông tin tấn công của một thế cờ, dùng chung cho sinh nước, kiểm tra
+	// hợp lệ, SEE và search. Board tính lười lần đầu cần rồi giữ trong StateInfo.
+	struct AttackInfo
 	{
-		ui activeColor;
-		ui castling;
-		ui enPassant;
-		ui halfMove;
-		ui fullMove;
-
-		ui capturedPiece;
-		ui capturedSquare;
-
-		ui moveFlags;
-		ui promotedPiece;
+		u64 checkers;	 // quân đối phương đang chiếu vua bên đi
+		u64 pinned[2];	 // [màu] quân của màu đó bị ghim vào vua mình
+		u64 pinners[2];	 // [màu] quân trượt của màu đó đang ghim quân đối phương
+		// [màu][loại quân, AllPieces = hợp]: ô bị tấn công. Vua đối phương coi như
+		// trong suốt, nên ô phía sau vua trên đường chiếu cũng bị tính là bị tấn công.
+		u64 attackedBy[2][7];
+	};
 
-		u64 zobristKey;
-		ui phaseValue;
-		std::array<int, 12> psqtValue;
+	// Phần của StateInfo mà doMove chép nguyên sang ply mới. Trivially
+	// copyable nên chép bằng phép gán, không cần memcpy/offsetof.
+	struct StateCopy
+	{
+		ui activeColor = White;
+		ui castling = 0;		  // mặc định không có quyền nhập thành
+		ui enPassant = NoSquare;
+		ui halfMove = 0;
+		ui fullMove = 1;
+		ui pliesFromNull = 0; // số ply từ null move gần nhất (giới hạn dò lặp nước)
+		// Khoảng cách (ply) tới lần xuất hiện trước của thế này, 0 nếu chưa lặp;
+		// âm khi lần trước cũng đã là một lần lặp (tức thế xuất hiện lần thứ 3)
+		int repetition = 0;
+
+		ui capturedPiece = NoPiece;
+		ui capturedSquare = NoSquare;
+
+		ui promotedPiece = promoNone;
+
+		u64 zobristKey = 0;
+		u64 pawnKey = 0;				   // Zobrist chỉ của các quân tốt (cho PawnTable)
+		ui phaseValue = 0;				   // tổng piecePhase của các quân trên bàn
+		std::array<int, 12> psqtValue{};   // tổng điểm nén (PSQT + giá trị quân) theo từng loại quân
+
+		NNUE::DirtyPieces dirty; // quân đã thay đổi ở nước vừa đi (cho NNUE)
+	};
+	static_assert(std::is_trivially_copyable_v<StateCopy>);
 
+	struct StateInfo : StateCopy
+	{
 		StateInfo *previous = nullptr;
 
-		StateInfo();
+		// Bộ nhớ đệm, không chép khi doMove: checkers/pin rẻ và cần ở mọi nút,
+		// attackedBy đắt hơn nên được tính riêng
+		bool kingInfoReady = false;
+		bool attacksReady = false;
+		AttackInfo attacks;
 	};
 
 	struct Board
@@ -80,21 +147,75 @@ namespace ChessEngine
 		std::array<StateInfo, MAX_PLY> stateStack; // undo stack
 		ui ply = 0;
 
+		// Accumulator NNUE theo ply, song song với stateStack. Chỉ được cấp phát
+		// (~256 KB) và tính khi đánh giá bằng mạng lần đầu, nên Board không dùng
+		// NNUE (perft, không nạp mạng) và các bản sao Board không phải mang theo.
+		using AccumulatorStack = std::array<NNUE::Accumulator, MAX_PLY>;
+		mutable std::unique_ptr<AccumulatorStack> accumulators;
+
 		Board(const Fen &fen);
+		// Bản sao độc lập: st và chuỗi previous trỏ vào stateStack của chính nó
+		Board(const Board &other);
+		Board &operator=(const Board &other);
+
+		// Rẽ nhánh theo bên đi một lần rồi chạy bản riêng cho màu đó
+		void doMove(const Move &move) { st->activeColor == White ? doMove<White>(move) : doMove<Black>(move); }
+		void undoMove(const Move &move) { st->previous->activeColor == White ? undoMove<White>(move) : undoMove<Black>(move); }
+
+		// Us = bên đi nước move (với undoMove: bên vừa đi)
+		template <Color Us> void doMove(const Move &move);
+		template <Color Us> void undoMove(const Move &move);
 
-		void doMove(const Move &move);
-		void undoMove(const Move &move);
+		// Null move: chỉ đổi bên đi (null-move pruning), không có quân nào di chuyển
+		void doNullMove();
+		void undoNullMove();
+
+		// Chỉ giữ lại keep ply lịch sử gần nhất (đủ cho luật lặp/50 nước) để
+		// ván dài không làm tràn stateStack; sau đó không thể undo quá điểm này
+		void trimHistory(ui keep = MAX_MOVE_RULE);
 
 		u64 computeZobrist(const StateInfo &s) const;
+		u64 computePawnKey() const;
+
+		u64 colorPieces(ui color) const;
+		u64 occupancy() const;
+		ui kingSquare(ui color) const;
+		u64 attackersTo(ui square, u64 occupied) const;
+		bool inCheck() const;
+
+		// Truy cập AttackInfo của thế hiện tại (tính lần đầu, sau đó O(1))
+		u64 checkers() const;
+		u64 pinned(ui color) const;
+		u64 pinners(ui color) const;
+		u64 attackedBy(ui color, ui type = AllPieces) const;
+		// Còn quân khác tốt và vua (chặn null move khi dễ zugzwang)
+		bool hasNonPawnMaterial(ui color) const;
+
+		// Tổng điểm nén PSQT (mg/eg) theo góc nhìn bên Trắng, O(1)
+		int psqtScore() const;
+
 		void printBoard() const;
+		// FEN của thế hiện tại (ô bắt tốt qua đường ghi đúng như st->enPassant)
+		std::string toFen() const;
 
 		bool hasBishopPaired(const Color &side) const;
 		bool sufficientMaterialToForceMate(Color &side) const;
 		bool fiftyMoveRule() const;
-		bool isDrawByRepetition() const;
+		// O(1) nhờ st->repetition. searchPly = khoảng cách tới gốc tìm kiếm: lặp
+		// lại một thế nằm sau gốc đã đủ là hòa, thế trước gốc vẫn cần lặp 3 lần
+		bool isDrawByRepetition(int searchPly = 0) const;
+		// Bên đi có một nước thuận nghịch đưa về thế đã gặp (tra bảng cuckoo),
+		// tức có thể ép hòa ngay cả trước khi đi nước đó
+		bool hasUpcomingRepetition(int searchPly) const;
 		bool isDrawByInsufficientMaterial() const;
 
 	private:
+		// Accumulator của các ply 0..lastPly phải tính lại (nếu đã cấp phát)
+		void invalidateAccumulators(ui lastPly);
+		void updateRepetition();
+		void computeKingInfo() const;
+		void computeAttacks() const;
+
 		void initBitboardAndList(const Fen &fen);
 		void initStateFromFen(const Fen &fen);
 	};
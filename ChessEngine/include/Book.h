@@ -0,0 +1,45 @@
+#pragma once
+#include "Board.h"
+#include "MappedFile.h"
+#include <random>
+
+namespace ChessEngine {
+
+	// Khóa Polyglot chuẩn của thế cờ (bảng Random64 của định dạng .bin), khác
+	// với zobristKey của engine
+	u64 polyglotKey(const Board &board);
+
+	struct BookMove {
+		Move move;
+		uint16_t weight = 0;
+	};
+
+	// Sách khai cuộc Polyglot (.bin): các mục 16 byte big-endian (key, move,
+	// weight, learn) đã sắp theo key. File được map chỉ đọc và tìm nhị phân
+	// trực tiếp trên vùng map, nên sách nhiều GB mở tức thì và không tốn heap.
+	class PolyglotBook {
+	public:
+		bool open(const std::string &path);
+		void close() { file.close(); }
+		bool isOpen() const { return file.isOpen(); }
+		u64 entryCount() const { return file.size() / EntrySize; }
+
+		// Mọi nước hợp lệ trong sách cho thế hiện tại, theo thứ tự trong file
+		std::vector<BookMove> moves(const Board &board) const;
+
+		// bestMove: nước có weight cao nhất; ngược lại chọn ngẫu nhiên theo weight.
+		// Move() nếu thế không có trong sách.
+		Move probe(const Board &board, bool bestMove, std::mt19937_64 &rng) const;
+
+	private:
+		static constexpr u64 EntrySize = 16;
+
+		MappedFile file;
+	};
+
+	// Khóa Polyglot của các thế mẫu trong đặc tả định dạng
+	bool runBookKeySuite(std::ostream &out = std::cout);
+
+	// In khóa Polyglot và các nước sách của thế fen
+	bool runBookProbe(const std::string &path, const std::string &fen, std::ostream &out = std::cout);
+}
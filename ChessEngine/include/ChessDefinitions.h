@@ -9,6 +9,8 @@
 #include <cstdint>
 #include <array>
 #include <random>
+#include <memory>
+#include <cstring>
 
 constexpr int MAX_MOVES = 256; //Kích thước của danh sách nước
 constexpr int MAX_PLY = 256;
@@ -26,13 +28,21 @@ enum Piece : unsigned int {
 	NoPiece
 };
 
+//Piece types (piece % 6)
+enum PieceType : unsigned int {
+	Pawn, Knight, Bishop, Rook, Queen, King,
+	AllPieces // chỉ số "mọi loại quân" trong các bảng theo loại quân
+};
+
+// constexpr để các bảng hướng đi toàn cục (bishopDirection, ...) được khởi tạo
+// tĩnh, không phụ thuộc thứ tự khởi tạo giữa các file với AttackTable Attack
 struct vector2D {
 	int x, y;
-	vector2D(int X = 0, int Y = 0) : x(X), y(Y) {}
-	vector2D operator+(const vector2D& other) const {
+	constexpr vector2D(int X = 0, int Y = 0) : x(X), y(Y) {}
+	constexpr vector2D operator+(const vector2D& other) const {
 		return vector2D(x + other.x, y + other.y);
 	}
-	vector2D operator-(const vector2D& other) const {
+	constexpr vector2D operator-(const vector2D& other) const {
 		return vector2D(x - other.x, y - other.y);
 	}
 };
@@ -41,6 +51,9 @@ enum Color : ui {
 	Black = 0, White = 1
 };
 
+constexpr ui makePiece(ui color, ui type) { return color == White ? type : type + 6; }
+constexpr ui typeOf(ui piece) { return piece % 6; }
+
 
 enum direction : int {
 	N = 8,
@@ -64,13 +77,15 @@ enum enumSquare : ui {
 	a8, b8, c8, d8, e8, f8, g8, h8, NoSquare
 };
 
+// Mã 4 bit của nước đi (bit 12..15 của Move): bit 3 = phong cấp, bit 2 = ăn quân.
+// Với nước phong cấp, 2 bit thấp là loại quân phong (promo - promoKnight).
 enum MoveFlag : ui {
-    quiet        = 0,
-    capture      = 1 << 0,
-    doublePush  = 1 << 1,
-    enPassant   = 1 << 2,
-    castling    = 1 << 3,
-    promotion   = 1 << 4
+    quiet       = 0,
+    doublePush  = 1,
+    castling    = 2,
+    capture     = 4,
+    enPassant   = 5, // = capture | 1
+    promotion   = 8
 };
 
 enum PromotionPiece : ui {
@@ -108,3 +123,45 @@ const ui castleMask[64] = {
 	15, 15, 15, 15, 15, 15, 15, 15,
 	 7, 15, 15, 15,  3, 15, 15, 11  // H�ng 8 (a8-h8): a8=7 (0111), e8=3 (0011), h8=11 (1011)
 };
+
+// ===== Hằng số theo màu =====
+// Dùng với tham số template Us (doMove, sinh nước) để mọi hướng đi, hàng và ô
+// nhập thành là hằng lúc biên dịch thay vì rẽ nhánh theo activeColor.
+
+// Dịch bitboard một bước theo hướng D, bỏ các ô tràn qua mép cột a/h
+template <int D>
+constexpr u64 shiftBB(u64 b)
+{
+	if constexpr (D == N) return b << 8;
+	else if constexpr (D == S) return b >> 8;
+	else if constexpr (D == E) return (b & ~HFile) << 1;
+	else if constexpr (D == W) return (b & ~AFile) >> 1;
+	else if constexpr (D == NE) return (b & ~HFile) << 9;
+	else if constexpr (D == NW) return (b & ~AFile) << 7;
+	else if constexpr (D == SE) return (b & ~HFile) >> 7;
+	else return (b & ~AFile) >> 9;
+}
+
+template <Color Us> constexpr int pawnPush = Us == White ? N : S;
+template <Color Us> constexpr int pawnCaptureWest = Us == White ? NW : SW;
+template <Color Us> constexpr int pawnCaptureEast = Us == White ? NE : SE;
+
+template <Color Us> constexpr u64 promotionRank = Us == White ? Rank8 : Rank1;
+// Hàng tốt tới sau bước đi đơn đầu tiên (hàng 3 / hàng 6), mới được đi tiếp bước đôi
+template <Color Us> constexpr u64 doublePushRank = Us == White ? (Rank1 << 16) : (Rank8 >> 16);
+
+// Ô tấn công của mọi tốt màu Us
+template <Color Us>
+constexpr u64 pawnAttacksBB(u64 pawns)
+{
+	return shiftBB<pawnCaptureWest<Us>>(pawns) | shiftBB<pawnCaptureEast<Us>>(pawns);
+}
+
+// Nhập thành: bit quyền (K=1, Q=2, k=4, q=8), ô vua và ô xe trước/sau
+template <Color Us> constexpr ui kingSideRight = Us == White ? 1 : 4;
+template <Color Us> constexpr ui queenSideRight = Us == White ? 2 : 8;
+template <Color Us> constexpr ui kingStartSquare = Us == White ? e1 : e8;
+template <Color Us> constexpr ui kingSideRookFrom = Us == White ? h1 : h8;
+template <Color Us> constexpr ui kingSideRookTo = Us == White ? f1 : f8;
+template <Color Us> constexpr ui queenSideRookFrom = Us == White ? a1 : a8;
+template <Color Us> constexpr ui queenSideRookTo = Us == White ? d1 : d8;
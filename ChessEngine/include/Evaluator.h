@@ -1 +1,17 @@
-#pragma once
\ No newline at end of file
+#pragma once
+#include "Board.h"
+#include "PawnTable.h"
+
+namespace ChessEngine {
+
+	constexpr int pieceValue[13] = {
+		100, 320, 330, 500, 900, 0,
+		100, 320, 330, 500, 900, 0,
+		0
+	};
+
+	// Đánh giá tĩnh theo góc nhìn bên đang đi (centipawn).
+	// Search truyền PawnTable riêng của luồng; bản không tham số dùng bảng thread_local.
+	int evaluate(const Board &board, PawnTable &pawns);
+	int evaluate(const Board &board);
+}
@@ -70,17 +70,225 @@ inline constexpr u64 bishopMagic[64] = {
 };
 
 
-u64 rookBlockerMask(ui index);
+// Các hàm dưới đây là constexpr: bảng tấn công được sinh lúc biên dịch
+// (xem AttackTable.cpp) nên không còn chi phí khởi tạo khi chương trình chạy.
 
-u64 bishopBlockerMask(ui index);
+inline constexpr vector2D bishopDirection[4] = {
+    {1,1},
+    {-1,1},
+    {1,-1},
+    {-1,-1}
+};
+
+/**
+ * @brief Generates the blocker mask for a rook on a given square.
+ *
+ * This function computes a bitboard mask representing all squares that could potentially block
+ * a rook's movement from the specified index on a standard 8x8 chessboard. The mask excludes
+ * edge squares, considering only the squares between the rook and the edge in each direction.
+ *
+ * @param index The square index (0-63) where the rook is located.
+ * @return u64 Bitboard mask of potential blocker squares for the rook.
+ */
+constexpr u64 rookBlockerMask(ui index)
+{
+    u64 blockerMask = C64(0);
+    int row = index / 8;
+    int col = index % 8;
+    for (int i = 1; i < 7 - row; i++) {
+        blockerMask |= C64(1) << (index + i * 8);
+    }
+    for (int i = row - 1; i > 0; i--) {
+        blockerMask |= C64(1) << (index - i * 8);
+    }
+    for (int i = 1; i < 7 - col; i++) {
+        blockerMask |= C64(1) << (index + i);
+    }
+    for (int i = col - 1; i > 0; i--) {
+        blockerMask |= C64(1) << (index - i);
+    }
+    return blockerMask;
+}
+
+/**
+ * @brief Generates the blocker mask for a bishop on a given square.
+ *
+ * This function calculates the mask representing all squares that could block
+ * the movement of a bishop from the specified index on a chessboard. The mask
+ * excludes edge squares and only includes squares between the bishop and the edge
+ * in all four diagonal directions.
+ *
+ * @param index The square index (0-63) for which to generate the blocker mask.
+ * @return u64 The blocker mask as a 64-bit unsigned integer.
+ */
+constexpr u64 bishopBlockerMask(ui index)
+{
+    u64 blockerMask = C64(0);
+    vector2D currentPosition(index % 8, index / 8);
+    for (int i = 1; i < 7; i++) {
+        for (int j = 0; j < 4; j++) {
+            vector2D updatedDirection(bishopDirection[j].x * i, bishopDirection[j].y * i);
+            vector2D sum = currentPosition + updatedDirection;
+            if (sum.x > 0 && sum.y > 0 && sum.x < 7 && sum.y < 7) {
+                blockerMask |= C64(1) << (sum.x + 8 * sum.y);
+            }
+        }
+    }
+    return blockerMask;
+}
+
+/**
+ * @brief Returns the attack bitboard for a rook on a given square with a given occupancy.
+ *
+ * This function calculates all squares a rook can attack from the specified square,
+ * considering the current occupancy bitboard. The rook's movement is blocked by any
+ * piece encountered in each direction.
+ *
+ * @param square The board square (0-63) where the rook is located.
+ * @param occupancy The occupancy bitboard representing blocked squares.
+ * @return u64 Bitboard of all squares attacked by the rook.
+ */
+constexpr u64 getRookAttack(int square, u64 occupancy) {
+    u64 attacks = 0ULL;
+    int rank = square / 8;
+    int file = square % 8;
+
+    // Move north
+    for (int r = rank + 1; r <= 7; r++) {
+        int sq = r * 8 + file;
+        attacks |= (1ULL << sq);
+        if (occupancy & (1ULL << sq)) break;
+    }
+
+    // Move south
+    for (int r = rank - 1; r >= 0; r--) {
+        int sq = r * 8 + file;
+        attacks |= (1ULL << sq);
+        if (occupancy & (1ULL << sq)) break;
+    }
+
+    // Move east
+    for (int f = file + 1; f <= 7; f++) {
+        int sq = rank * 8 + f;
+        attacks |= (1ULL << sq);
+        if (occupancy & (1ULL << sq)) break;
+    }
+
+    // Move west
+    for (int f = file - 1; f >= 0; f--) {
+        int sq = rank * 8 + f;
+        attacks |= (1ULL << sq);
+        if (occupancy & (1ULL << sq)) break;
+    }
 
-u64 getRookAttack(int square, u64 occupancy);
+    return attacks;
+}
+
+/**
+ * @brief Returns the attack bitboard for a bishop on a given square with a given occupancy.
+ *
+ * This function calculates all squares a bishop can attack from the specified square,
+ * considering the current occupancy bitboard. The bishop's movement is blocked by any
+ * piece encountered in each diagonal direction.
+ *
+ * @param square The board square (0-63) where the bishop is located.
+ * @param occupancy The occupancy bitboard representing blocked squares.
+ * @return u64 Bitboard of all squares attacked by the bishop.
+ */
+constexpr u64 getBishopAttack(int square, u64 occupancy) {
+    u64 attacks = 0ULL;
+    int rank = square / 8;
+    int file = square % 8;
+
+    // Diagonal northeast (NE)
+    for (int r = rank + 1, f = file + 1; r <= 7 && f <= 7; r++, f++) {
+        int sq = r * 8 + f;
+        attacks |= (1ULL << sq);
+        if (occupancy & (1ULL << sq)) break;
+    }
+
+    // Diagonal northwest (NW)
+    for (int r = rank + 1, f = file - 1; r <= 7 && f >= 0; r++, f--) {
+        int sq = r * 8 + f;
+        attacks |= (1ULL << sq);
+        if (occupancy & (1ULL << sq)) break;
+    }
+
+    // Diagonal southeast (SE)
+    for (int r = rank - 1, f = file + 1; r >= 0 && f <= 7; r--, f++) {
+        int sq = r * 8 + f;
+        attacks |= (1ULL << sq);
+        if (occupancy & (1ULL << sq)) break;
+    }
+
+    // Diagonal southwest (SW)
+    for (int r = rank - 1, f = file - 1; r >= 0 && f >= 0; r--, f--) {
+        int sq = r * 8 + f;
+        attacks |= (1ULL << sq);
+        if (occupancy & (1ULL << sq)) break;
+    }
+
+    return attacks;
+}
+
+// Fancy magic: ô square chỉ dùng đúng 2^(64 - shift) entry liên tiếp trong một
+// bảng chung cho cả xe và tượng (~840 KB thay vì 2.3 MB của [64][4096] + [64][512]).
+// 64 - shift cũng là số bit của mặt nạ nên bố cục này dùng chung cho chỉ số PEXT.
+struct SliderLayout {
+    ui rookOffset[64];
+    ui bishopOffset[64];
+    ui size;
+};
 
-u64 getBishopAttack(int square, u64 occupancy);
+constexpr SliderLayout makeSliderLayout()
+{
+    SliderLayout layout{};
+    for (int square = 0; square < 64; square++) {
+        layout.rookOffset[square] = layout.size;
+        layout.size += 1u << (64 - rookShift[square]);
+    }
+    for (int square = 0; square < 64; square++) {
+        layout.bishopOffset[square] = layout.size;
+        layout.size += 1u << (64 - bishopShift[square]);
+    }
+    return layout;
+}
 
-void rookAttackTable(u64 (&rookAttackTable)[64][4096]);
+inline constexpr SliderLayout sliderLayout = makeSliderLayout();
+inline constexpr ui SLIDER_TABLE_SIZE = sliderLayout.size;
 
-void bishopAttackTable(u64 (&BishopAttackTable)[64][512]);
+constexpr u64 magicIndex(u64 occupancy, u64 mask, u64 magic, int shift)
+{
+    return ((occupancy & mask) * magic) >> shift;
+}
 
-std::vector<u64> blockerBoard(const u64& blockerMask);
+/**
+ * @brief Fills the shared fancy slider table for every rook and bishop square.
+ *
+ * Every subset of a blocker mask is enumerated with the carry-rippler trick
+ * (occ = (occ - mask) & mask), so no temporary blocker list has to be allocated
+ * and the whole table can be built in a constant expression.
+ * index has the signature of magicIndex: the magic table is built at compile
+ * time, the PEXT one at startup (AttackTable.cpp).
+ */
+template <typename IndexFunction>
+constexpr void sliderTable(u64 *table, IndexFunction index)
+{
+    for (int square = 0; square < 64; square++) {
+        u64 mask = rookMask[square];
+        u64 occupancy = 0;
+        do {
+            u64 slot = index(occupancy, mask, rookMagic[square], rookShift[square]);
+            table[sliderLayout.rookOffset[square] + slot] = getRookAttack(square, occupancy);
+            occupancy = (occupancy - mask) & mask;
+        } while (occupancy);
 
+        mask = bishopMask[square];
+        occupancy = 0;
+        do {
+            u64 slot = index(occupancy, mask, bishopMagic[square], bishopShift[square]);
+            table[sliderLayout.bishopOffset[square] + slot] = getBishopAttack(square, occupancy);
+            occupancy = (occupancy - mask) & mask;
+        } while (occupancy);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "ChessDefinitions.h"
+
+namespace ChessEngine {
+
+	// File map chỉ đọc (mmap / MapViewOfFile). Dữ liệu không được chép lên heap:
+	// hệ điều hành nạp trang khi cần, và page cache được dùng chung giữa các
+	// luồng lẫn các tiến trình engine mở cùng file (bảng tàn cuộc, sách khai cuộc).
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		~MappedFile() { close(); }
+		MappedFile(const MappedFile &) = delete;
+		MappedFile &operator=(const MappedFile &) = delete;
+
+		// randomAccess: báo cho hệ điều hành không cần đọc trước (truy cập rải rác)
+		bool open(const std::string &path, bool randomAccess = true);
+		void close();
+
+		bool isOpen() const { return base != nullptr; }
+		const uint8_t *data() const { return static_cast<const uint8_t *>(base); }
+		u64 size() const { return length; }
+
+	private:
+		void *base = nullptr;
+		u64 length = 0;
+		void *mapping = nullptr; // HANDLE của file mapping trên Windows
+	};
+}
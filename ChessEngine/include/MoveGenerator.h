@@ -0,0 +1,39 @@
+#pragma once
+#include "Board.h"
+
+namespace ChessEngine {
+
+	// Các giai đoạn sinh nước. Captures và Quiets chia đôi tập nước hợp lệ:
+	// Captures = mọi nước ăn quân (kể cả ăn tốt qua đường, phong cấp có ăn quân)
+	//            + phong Hậu không ăn quân,
+	// Quiets   = phần còn lại (kể cả nhập thành và phong cấp dưới).
+	// Evasions chỉ dùng khi bị chiếu; Legal = tất cả nước hợp lệ.
+	enum GenType : ui {
+		Captures,
+		Quiets,
+		Evasions,
+		Legal
+	};
+
+	// Mọi hàm sinh ra nước HỢP LỆ (dùng pin mask + checker mask, không cần
+	// doMove/undoMove để kiểm tra). Nếu đang bị chiếu, Captures/Quiets chỉ
+	// trả về các nước thoát chiếu thuộc giai đoạn đó.
+	template <GenType Type>
+	void generate(const Board &board, MoveList &moveList);
+
+	void generateCaptures(const Board &board, MoveList &moveList);
+	void generateQuiets(const Board &board, MoveList &moveList);
+	void generateEvasions(const Board &board, MoveList &moveList);
+	void generateLegalMoves(const Board &board, MoveList &moveList);
+
+	// Kiểm tra một nước lấy từ nơi khác (TT, killer, counter-move) có hợp lệ
+	// trong thế hiện tại không, mà không cần sinh danh sách nước
+	bool isLegal(const Board &board, Move move);
+
+	// Nước hợp lệ có ký hiệu UCI text ("e2e4", "e7e8q"), Move() nếu không có
+	Move parseMove(const Board &board, const std::string &text);
+
+	// Nước hợp lệ có ký hiệu SAN của PGN ("Nbxd7", "exd8=Q+", "O-O"), bỏ qua
+	// hậu tố +#!?; Move() nếu không có hoặc mơ hồ
+	Move parseSan(const Board &board, const std::string &text);
+}
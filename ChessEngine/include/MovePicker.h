@@ -0,0 +1,89 @@
+#pragma once
+#include "Board.h"
+#include <algorithm>
+
+namespace ChessEngine {
+
+	// Giới hạn tuyệt đối của mọi bảng history (vừa int16)
+	constexpr int HISTORY_MAX = 16384;
+
+	// "History gravity": bonus lớn dần khi entry nhỏ, tự bão hòa ở ±HISTORY_MAX
+	inline void updateHistory(int16_t &entry, int bonus)
+	{
+		bonus = std::clamp(bonus, -HISTORY_MAX, HISTORY_MAX);
+		entry += int16_t(bonus - entry * std::abs(bonus) / HISTORY_MAX);
+	}
+
+	// Butterfly history: [màu][from][to]
+	struct ButterflyHistory {
+		int16_t table[2][64][64];
+	};
+
+	// History theo [quân][ô đích] của nước hiện tại
+	struct PieceToHistory {
+		int16_t table[12][64];
+	};
+
+	// Continuation history: [quân][ô đích] của nước trước -> PieceToHistory
+	struct ContinuationHistory {
+		PieceToHistory table[12][64];
+	};
+
+	// Counter-move: nước đáp trả tốt nhất cho [quân][ô đích] của nước trước
+	struct CounterMoveHistory {
+		Move table[12][64];
+	};
+
+	// Nước thuộc giai đoạn Captures của MoveGenerator (ăn quân hoặc phong Hậu)
+	inline bool isTactical(Move move)
+	{
+		return move.isCapture() || (move.isPromotion() && move.promotionType() == promoQueen);
+	}
+
+	// Sinh và sắp xếp nước theo từng giai đoạn, chỉ khi cần:
+	//   TT move -> captures tốt (MVV-LVA, SEE >= 0) -> killer 1, 2 -> counter-move
+	//   -> quiets (butterfly + continuation history) -> captures xấu.
+	// Khi bị chiếu: TT move -> mọi nước thoát chiếu (captures trước).
+	// Quiescence: TT move (nếu là nước chiến thuật) -> mọi capture theo MVV-LVA,
+	// việc cắt tỉa bằng SEE/delta để cho qsearch.
+	// Mỗi lần next() chỉ chọn nước tốt nhất còn lại (selection sort từng phần).
+	class MovePicker {
+	public:
+		MovePicker(const Board &board, Move ttMove, const Move *killers, Move counterMove,
+			const ButterflyHistory *history, const PieceToHistory *const *continuation);
+
+		// Dùng cho quiescence search
+		MovePicker(const Board &board, Move ttMove,
+			const ButterflyHistory *history, const PieceToHistory *const *continuation);
+
+		// Nước hợp lệ tiếp theo, Move() khi hết
+		Move next();
+
+	private:
+		enum Stage {
+			MainTT, CaptureInit, GoodCaptures, Refutations, QuietInit, Quiets, BadCaptures,
+			EvasionTT, EvasionInit, Evasions,
+			QSearchTT, QCaptureInit, QCaptures,
+			Done
+		};
+
+		void scoreCaptures(int begin, int end);
+		void scoreQuiets(int begin, int end);
+		ExtMove &pickBest(int index, int end);
+		bool isRefutation(Move move) const;
+
+		const Board &board;
+		const ButterflyHistory *history;
+		const PieceToHistory *const *continuation; // [0] = 1 ply trước, [1] = 2 ply trước
+
+		Move ttMove;
+		Move refutations[3]; // killer 1, killer 2, counter-move
+		int refutationIndex = 0;
+
+		Stage stage;
+		MoveList moves;
+		int current = 0;
+		int endCaptures = 0;
+		int endBadCaptures = 0; // captures xấu được dồn về đầu danh sách
+	};
+}
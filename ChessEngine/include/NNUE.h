@@ -0,0 +1,60 @@
+#pragma once
+#include "ChessDefinitions.h"
+
+// Mạng đánh giá cập nhật tăng dần (NNUE) dạng đơn giản:
+//   768 input (2 màu x 6 loại quân x 64 ô, theo góc nhìn từng bên)
+//   -> HIDDEN neuron mỗi bên (int16, cộng/trừ tăng dần theo nước đi)
+//   -> CReLU, ghép [bên đi, bên kia] -> 1 output.
+//
+// File mạng (little-endian):
+//   char magic[4] = "CENN", u32 version = 1, u32 hidden = HIDDEN
+//   int16 featureWeights[768][HIDDEN], int16 featureBias[HIDDEN]
+//   int16 outputWeights[2 * HIDDEN],   int32 outputBias (đã nhân QA * QB)
+
+namespace ChessEngine {
+
+	struct Board;
+
+	namespace NNUE {
+
+		constexpr int INPUTS = 768;
+		constexpr int HIDDEN = 256;
+		constexpr int QA = 255;	  // lượng tử hóa lớp ẩn
+		constexpr int QB = 64;	  // lượng tử hóa lớp output
+		constexpr int SCALE = 400;
+
+		// Accumulator của một ply; Board cấp phát lười một mảng song song với stateStack
+		struct alignas(64) Accumulator {
+			int16_t values[2][HIDDEN]; // [Black/White góc nhìn]
+			bool computed = false;
+		};
+
+		// Các quân doMove đã di chuyển, để cập nhật accumulator từ ply trước.
+		// from/to = NoSquare nghĩa là quân được thêm/bỏ khỏi bàn.
+		struct DirtyPieces {
+			int count = 0;
+			ui piece[3];
+			ui from[3];
+			ui to[3];
+		};
+
+		enum class Backend { Scalar, SSE41, AVX2 };
+
+		bool load(const std::string &path);
+		void initRandom(u64 seed); // mạng ngẫu nhiên, chỉ dùng để đo tốc độ
+		bool isLoaded();
+		void unload();
+
+		// Chọn kernel SIMD theo CPU (gọi tự động khi load)
+		Backend detectBackend();
+		void setBackend(Backend backend);
+		Backend currentBackend();
+		const char *backendName(Backend backend);
+
+		// Điểm centipawn theo góc nhìn bên đang đi
+		int evaluate(const Board &board);
+
+		// Đo số lần đánh giá mỗi giây (refresh + cập nhật tăng dần) với mỗi backend
+		void runEvalBench(std::ostream &out = std::cout);
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "Board.h"
+#include <vector>
+
+namespace ChessEngine {
+
+	// Kết quả đánh giá cấu trúc tốt, chỉ phụ thuộc vào bitboard tốt (pawnKey).
+	// Lá chắn tốt còn phụ thuộc ô vua nên được tính lười và cache theo kingSquare.
+	struct PawnEntry {
+		u64 key = 0;
+		int score = 0;		   // điểm nén mg/eg theo góc nhìn Trắng
+		u64 passed[2] = {};	   // tốt thông theo màu [Black/White]
+		ui kingSquare[2] = { NoSquare, NoSquare };
+		int shelter[2] = {};   // điểm nén lá chắn tốt cho vua mỗi bên
+
+		// Điểm lá chắn của color với vua ở kingSq, tính lại khi vua đổi ô
+		int kingShelter(const Board &board, ui color, ui kingSq);
+	};
+
+	// Bảng băm cấu trúc tốt, một bảng cho mỗi luồng tìm kiếm nên không cần đồng bộ.
+	// Luôn ghi đè: entry rẻ để tính lại, và pawnKey hầu như không đổi giữa các nút.
+	class PawnTable {
+	public:
+		static constexpr size_t DefaultEntries = 16384; // lũy thừa của 2
+
+		explicit PawnTable(size_t entryCount = DefaultEntries);
+
+		// Trả về entry của cấu trúc tốt hiện tại, tính mới nếu chưa có
+		PawnEntry *probe(const Board &board);
+		void clear();
+
+		u64 probes() const { return probeCount; }
+		u64 hits() const { return hitCount; }
+		double hitRate() const { return probeCount ? (double)hitCount / probeCount : 0.0; }
+
+	private:
+		std::vector<PawnEntry> entries;
+		size_t mask;
+		u64 probeCount = 0;
+		u64 hitCount = 0;
+	};
+}
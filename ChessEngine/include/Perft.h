@@ -0,0 +1,75 @@
+#pragma once
+#include "Board.h"
+#include <atomic>
+
+namespace ChessEngine {
+
+	struct PerftResult {
+		u64 nodes = 0;
+		double seconds = 0.0;
+
+		u64 nps() const { return seconds > 0.0 ? (u64)(nodes / seconds) : nodes; }
+	};
+
+	// Bảng băm perft dùng chung giữa các luồng, không khóa.
+	// Mỗi entry lưu (key ^ data) và data; entry bị ghi dở (torn write)
+	// sẽ không khớp key khi kiểm tra nên tự động bị bỏ qua.
+	class PerftTable {
+	public:
+		explicit PerftTable(size_t megabytes);
+
+		bool probe(u64 key, int depth, u64 &nodes) const;
+		void store(u64 key, int depth, u64 nodes);
+
+		u64 hits() const { return hitCount.load(std::memory_order_relaxed); }
+
+	private:
+		struct Entry {
+			std::atomic<u64> check; // key ^ data
+			std::atomic<u64> data;  // nodes << 8 | depth
+		};
+
+		static u64 mixDepth(u64 key, int depth) { return key ^ (C64(0x9E3779B97F4A7C15) * (u64)depth); }
+
+		std::unique_ptr<Entry[]> entries;
+		size_t mask;
+		mutable std::atomic<u64> hitCount{ 0 };
+	};
+
+	struct ParallelPerftResult : PerftResult {
+		std::vector<u64> threadNodes;   // số nút mỗi luồng đã đếm
+		std::vector<double> threadBusy; // thời gian làm việc thực của mỗi luồng
+		u64 tableHits = 0;
+
+		// Tổng thời gian làm việc của các luồng / thời gian thực
+		double scaling() const;
+	};
+
+	// Một vị trí chuẩn cùng số nút perft đã biết theo từng độ sâu
+	struct PerftPosition {
+		const char *name;
+		const char *fen;
+		std::vector<u64> expected; // expected[d - 1] = perft(d)
+	};
+
+	// Đếm số nút lá; ở depth 1 đếm thẳng số nước (bulk counting)
+	u64 perft(Board &board, int depth);
+
+	// Perft có đo thời gian
+	PerftResult runPerft(Board &board, int depth);
+
+	// Chia các nước gốc cho threads luồng, mỗi luồng một bản sao Board.
+	// table == nullptr: không dùng bảng băm. Kết quả trùng khớp perft().
+	ParallelPerftResult parallelPerft(const Board &board, int depth, int threads, PerftTable *table = nullptr);
+	void printParallelPerft(const ParallelPerftResult &result, std::ostream &out = std::cout);
+
+	// In số nút theo từng nước gốc, sau đó tổng số nút, thời gian và NPS
+	PerftResult divide(Board &board, int depth, std::ostream &out = std::cout);
+
+	const std::vector<PerftPosition> &perftSuite();
+
+	// Chạy bộ vị trí chuẩn tới maxDepth (hoặc độ sâu lớn nhất có dữ liệu).
+	// Trả về false nếu có vị trí nào lệch số nút. threads > 1 hoặc
+	// hashMB > 0 thì chạy bằng parallelPerft.
+	bool runPerftSuite(int maxDepth, int threads = 1, size_t hashMB = 0, std::ostream &out = std::cout);
+}
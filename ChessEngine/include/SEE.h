@@ -0,0 +1,25 @@
+#pragma once
+#include "Board.h"
+
+namespace ChessEngine {
+
+	// Static Exchange Evaluation trên ô đích của move: hai bên lần lượt ăn lại
+	// bằng quân rẻ nhất, quân trượt phía sau (x-ray) lộ ra khi quân phía trước
+	// rời ô. Quân bị ghim không ăn lại khi quân ghim nó còn trên bàn; vua chỉ
+	// ăn khi đối phương hết quân tấn công.
+
+	// Vật chất nhận được ngay bởi move: quân bị ăn cộng phần lợi phong cấp
+	int captureGain(const Board &board, Move move);
+
+	// Giá trị trao đổi chính xác (centipawn, theo pieceValue) bằng swap list
+	int see(const Board &board, Move move);
+
+	// see(board, move) >= threshold, dừng sớm ngay khi biết kết quả
+	bool seeGe(const Board &board, Move move, int threshold = 0);
+
+	// Bộ vị trí kiểu EPD (fen ; nước UCI ; giá trị SEE mong đợi)
+	bool runSeeSuite(std::ostream &out = std::cout);
+
+	// Thời gian mỗi lần gọi see()/seeGe() trên các nước ăn quân của bộ bench
+	void runSeeBench(std::ostream &out = std::cout);
+}
@@ -0,0 +1,238 @@
+﻿#pragma once
+#include "Board.h"
+#include "PawnTable.h"
+#include "TimeManager.h"
+#include "MovePicker.h"
+#include "Syzygy.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+
+namespace ChessEngine {
+
+	constexpr int MAX_SEARCH_PLY = 128;
+	constexpr int MAX_DEPTH = 64;
+
+	constexpr int VALUE_DRAW = 0;
+	constexpr int VALUE_MATE = 32000;
+	constexpr int VALUE_INFINITE = 32001;
+	constexpr int VALUE_NONE = 32002;
+	constexpr int VALUE_MATE_IN_MAX_PLY = VALUE_MATE - MAX_SEARCH_PLY;
+	// Thắng/thua chắc chắn theo bảng tàn cuộc: dải ngay dưới điểm chiếu hết
+	constexpr int VALUE_TB_WIN = VALUE_MATE_IN_MAX_PLY - 1;
+	constexpr int VALUE_TB_WIN_IN_MAX_PLY = VALUE_TB_WIN - MAX_SEARCH_PLY;
+
+	// Cửa sổ aspiration ban đầu (centipawn) và độ sâu bắt đầu dùng nó
+	constexpr int ASPIRATION_WINDOW = 25;
+	constexpr int ASPIRATION_MIN_DEPTH = 5;
+
+	// Quiescence: độ sâu ghi vào TT, và biên an toàn của delta pruning (centipawn)
+	constexpr int DEPTH_QS = 0;
+	constexpr int DELTA_MARGIN = 200;
+
+	// Mỗi luồng chỉ đọc đồng hồ sau mỗi chừng này nút (lũy thừa của 2)
+	constexpr u64 TIME_CHECK_NODES = 2048;
+
+	// Bật/tắt từng kỹ thuật tìm kiếm chọn lọc lúc chạy (UCI option, featurebench)
+	// để đo ảnh hưởng lên thời gian tới độ sâu và sức cờ khi tự đấu
+	struct SearchFeatures {
+		bool nullMove = true;
+		bool lmr = true;
+		bool reverseFutility = true;
+		bool futility = true;
+		bool lmp = true;
+		bool razoring = true;
+		bool checkExtension = true;
+		bool singularExtension = true;
+	};
+
+	// Tên UCI option của từng cờ trong SearchFeatures
+	struct SearchFeatureOption {
+		const char *name;
+		bool SearchFeatures::*flag;
+	};
+	const std::vector<SearchFeatureOption> &searchFeatureOptions();
+
+	struct SearchLimits {
+		int depth = MAX_DEPTH;
+		u64 nodes = 0;	   // 0 = không giới hạn
+		int moveTime = 0;  // ms, 0 = không giới hạn
+		bool infinite = false;
+		bool ponder = false; // như infinite cho tới khi SearchPool::ponderhit()
+
+		// Đồng hồ ván đấu (UCI wtime/btime/winc/binc/movestogo), theo [Black/White]
+		int time[2] = { 0, 0 };
+		int inc[2] = { 0, 0 };
+		int movesToGo = 0;
+		int moveOverhead = 10; // ms trừ hao cho độ trễ giao tiếp với GUI
+
+		SearchFeatures features;
+
+		// Syzygy: dò WDL trong cây khi số quân <= syzygyProbeLimit (thế có đúng
+		// bằng số quân đó chỉ dò khi depth >= syzygyProbeDepth); syzygy50MoveRule
+		// = cursed win/blessed loss tính là hòa
+		int syzygyProbeLimit = Syzygy::MAX_PIECES;
+		int syzygyProbeDepth = 1;
+		bool syzygy50MoveRule = true;
+	};
+
+	// Kết quả sau mỗi vòng iterative deepening
+	struct SearchInfo {
+		int depth = 0;
+		int score = 0;
+		u64 nodes = 0;
+		u64 qnodes = 0; // phần của nodes nằm trong quiescence search
+		int timeMs = 0;
+		int hashfull = 0;
+		u64 tbHits = 0; // số lần dò bảng tàn cuộc thành công
+		Move bestMove;
+		std::vector<Move> pv;
+
+		// Thống kê thứ tự nước: tỉ lệ cắt beta ngay ở nước đầu tiên
+		u64 betaCutoffs = 0;
+		u64 firstMoveCutoffs = 0;
+		double firstMoveCutoffRate() const { return betaCutoffs ? (double)firstMoveCutoffs / betaCutoffs : 0.0; }
+	};
+
+	// Trạng thái dùng chung giữa các luồng của một lần tìm kiếm
+	struct SearchShared {
+		std::atomic<bool> stop{ false };
+		std::atomic<u64> nodes{ 0 }; // các luồng cộng dồn theo lô, không phải mỗi nút
+		std::atomic<bool> ponder{ false };
+	};
+
+	// Bảng thứ tự nước của một luồng (~1.2 MB, cấp phát trên heap)
+	struct SearchHistories {
+		ButterflyHistory butterfly;
+		CounterMoveHistory counterMoves;
+		ContinuationHistory continuation;
+	};
+
+	// Thông tin mỗi ply trên đường tìm kiếm hiện tại
+	struct SearchStack {
+		Move move;
+		ui movedPiece = NoPiece;
+		PieceToHistory *contHist = nullptr; // continuation history của nước ở ply này
+		Move killers[2];
+		Move excludedMove;		  // nước bị loại trong tìm kiếm singular
+		int staticEval = VALUE_NONE; // VALUE_NONE khi bị chiếu
+	};
+
+	// Negamax alpha-beta (fail-soft) với PVS, iterative deepening và
+	// aspiration window. Mỗi Searcher có bản sao Board riêng.
+	class Searcher {
+	public:
+		// threadId 0 là luồng chính; luồng phụ (Lazy SMP) bỏ qua một số độ sâu
+		explicit Searcher(const Board &rootBoard, SearchShared *sharedState = nullptr, int threadId = 0,
+			PawnTable *pawnTable = nullptr);
+
+		SearchInfo think(const SearchLimits &limits);
+
+		// Gọi sau mỗi độ sâu hoàn tất (in "info ..." cho UCI/bench)
+		std::function<void(const SearchInfo &)> onIteration;
+
+		u64 nodes = 0;
+		u64 qnodes = 0;
+		u64 tbHits = 0;
+
+	private:
+		int aspiration(int depth, int previousScore);
+		int negamax(int alpha, int beta, int depth, int ply);
+		int qsearch(int alpha, int beta, int ply);
+		int quietHistory(const SearchStack *ss, Move move) const;
+		void updateQuietStats(SearchStack *ss, Move move, int depth, const Move *quiets, int quietCount);
+		bool isDraw(int ply) const;
+		bool skipDepth(int depth) const;
+		bool stopped() const { return shared->stop.load(std::memory_order_relaxed); }
+		void checkLimits();
+		void rankRootMoves(const MoveList &rootMoves);
+		bool isRootTbMove(Move move) const;
+		u64 totalNodes() const;
+		int elapsedMs() const;
+
+		Board board;
+		SearchLimits limits;
+		std::chrono::steady_clock::time_point startTime;
+
+		std::unique_ptr<SearchHistories> histories;
+		// stack[ply + 2]: hai phần tử đầu là lính canh cho ply -1, -2
+		SearchStack stack[MAX_SEARCH_PLY + 2];
+		u64 betaCutoffs = 0;
+		u64 firstMoveCutoffs = 0;
+
+		int rootDepth = 0;
+
+		// Gốc nằm trong bảng tàn cuộc: chỉ tìm các nước có hạng tốt nhất,
+		// báo điểm của bảng khi search chưa thấy chiếu hết
+		bool rootInTB = false;
+		int rootTbScore = 0;
+		std::vector<uint16_t> rootTbMoves;
+		int tbProbeLimit = 0; // số quân tối đa được dò trong cây, 0 = tắt
+
+		TimeManager timeManager;
+		// Số nút đã dùng cho mỗi nước ở gốc, theo [from][to]
+		u64 rootMoveNodes[64][64];
+
+		SearchShared ownShared;
+		SearchShared *shared;
+		int threadId;
+
+		// Bảng tốt của luồng; SearchPool giữ nó qua các lần tìm để còn "ấm"
+		std::unique_ptr<PawnTable> ownPawns;
+		PawnTable *pawns;
+		u64 flushedNodes = 0;
+
+		// Bảng PV tam giác: pvTable[ply] chứa PV bắt đầu từ ply đó
+		Move pvTable[MAX_SEARCH_PLY][MAX_SEARCH_PLY];
+		int pvLength[MAX_SEARCH_PLY];
+		Move previousPv[MAX_SEARCH_PLY];
+		int previousPvLength = 0;
+	};
+
+	// Lazy SMP: N luồng cùng tìm từ gốc, mỗi luồng một Searcher, chỉ chia sẻ TT.
+	// Nước cuối cùng được chọn bằng bỏ phiếu theo độ sâu và điểm.
+	class SearchPool {
+	public:
+		void setThreads(int count) { threads = std::max(1, count); }
+		int threadCount() const { return threads; }
+
+		// Chặn cho đến khi tìm xong; onIteration chỉ nhận kết quả của luồng chính
+		SearchInfo think(const Board &board, const SearchLimits &limits,
+			std::function<void(const SearchInfo &)> onIteration = nullptr);
+
+		// An toàn khi gọi từ luồng khác (UCI "stop", "ponderhit")
+		void stop() { shared.stop = true; }
+		// think() không tự xóa cờ dừng (chỉ xóa khi kết thúc): gọi trên luồng
+		// điều khiển trước khi tạo luồng chạy think() để "stop" tới trước khi
+		// luồng đó kịp chạy không bị mất
+		void resetStop() { shared.stop = false; }
+		void ponderhit() { shared.ponder = false; }
+
+		// Xóa dữ liệu giữa các ván (UCI "ucinewgame"); không gọi khi đang tìm
+		void clear();
+
+		// Tỉ lệ trúng PawnTable cộng dồn của mọi luồng
+		double pawnHitRate() const;
+
+	private:
+		int threads = 1;
+		SearchShared shared;
+		std::vector<std::unique_ptr<PawnTable>> pawnTables;
+	};
+
+	// Điểm chiếu hết dạng "mate N" hay centipawn, theo định dạng UCI
+	std::string scoreToString(int score);
+	void printSearchInfo(const SearchInfo &info, std::ostream &out = std::cout);
+
+	const std::vector<std::string> &benchPositions();
+
+	// Chạy bộ vị trí bench cố định tới depth, in thời gian tới độ sâu và NPS
+	void runBench(int depth, int threads = 1, std::ostream &out = std::cout);
+
+	// Bộ bench với mọi kỹ thuật bật, rồi lần lượt tắt từng cái: nút và thời gian tới depth
+	void runFeatureBench(int depth, std::ostream &out = std::cout);
+
+	// Thời gian tới depth trên bộ bench với 1, 2, 4, ... maxThreads luồng
+	void runSmpBench(int depth, int maxThreads, std::ostream &out = std::cout);
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "Board.h"
+
+// Dò bảng tàn cuộc Syzygy (.rtbw = thắng/hòa/thua, .rtbz = số ply tới lần
+// "về 0" của luật 50 nước) cho thế tối đa 7 quân.
+//
+// File được map chỉ đọc (mmap / MapViewOfFile) lần đầu cần tới và dùng chung
+// cho mọi luồng tìm kiếm; dữ liệu nằm trong page cache nên nhiều tiến trình
+// engine cũng dùng chung. Định dạng file và cách đánh chỉ số theo bộ sinh
+// bảng của Ronald de Man (tbgen / Fathom).
+
+namespace ChessEngine {
+
+	namespace Syzygy {
+
+		constexpr int MAX_PIECES = 7;
+
+		// Kết quả WDL theo góc nhìn bên đi. Cursed win / blessed loss: thắng/thua
+		// nhưng bị luật 50 nước biến thành hòa.
+		enum WDLScore : int {
+			WDLLoss = -2,
+			WDLBlessedLoss = -1,
+			WDLDraw = 0,
+			WDLCursedWin = 1,
+			WDLWin = 2,
+		};
+
+		enum ProbeState : int {
+			ProbeFail = 0,          // thiếu bảng hoặc file lỗi
+			ProbeOk = 1,
+			ProbeChangeSide = -1,   // bảng DTZ chỉ lưu cho bên kia đi
+			ProbeZeroingBest = 2,   // nước tốt nhất là ăn quân/đi tốt
+		};
+
+		// Danh sách thư mục ngăn bởi ':' (';' trên Windows), rỗng hoặc "<empty>" để
+		// tắt. Chỉ kiểm tra file nào tồn tại, chưa map. Trả về số bảng WDL tìm thấy.
+		// Không gọi khi đang tìm kiếm.
+		int init(const std::string &paths);
+
+		// Số quân lớn nhất có bảng (0 = không có bảng nào)
+		int maxPieces();
+
+		// Dò WDL (có tính nước ăn quân/qua đường mà bảng không lưu). board được
+		// đi thử rồi trả lại nguyên trạng. Thế không được còn quyền nhập thành.
+		WDLScore probeWdl(Board &board, ProbeState &state);
+
+		// Số ply tới lần về 0 (dấu theo WDL, ±101.. cho cursed/blessed), 0 = hòa
+		int probeDtz(Board &board, ProbeState &state);
+
+		// Xếp hạng các nước ở gốc: rank cao hơn là tốt hơn, score là điểm để báo
+		// cho GUI. Thử DTZ trước (giữ tiến triển), thiếu thì dùng WDL.
+		// Trả về false nếu gốc không dò được.
+		struct RootMove {
+			Move move;
+			int rank = 0;
+			int score = 0;
+		};
+		bool rankRootMoves(Board &board, std::vector<RootMove> &moves, bool rule50, bool &dtzAvailable);
+
+		// In WDL/DTZ của thế fen và xếp hạng các nước ở gốc (lệnh "syzygy")
+		bool runProbe(const std::string &paths, const std::string &fen, std::ostream &out = std::cout);
+
+		// Kiểm tra WDL/DTZ của các thế 3-5 quân đã biết kết quả (lệnh
+		// "syzygytest"); thế thiếu bảng được bỏ qua
+		bool runSuite(const std::string &paths, std::ostream &out = std::cout);
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "ChessDefinitions.h"
+
+namespace ChessEngine {
+
+	struct SearchLimits;
+
+	// Phân bổ thời gian cho một nước đi.
+	//   optimum (mềm): chỉ xét sau mỗi vòng iterative deepening, co giãn theo độ
+	//                  ổn định của nước tốt nhất, mức tụt điểm và tỉ lệ nút dành
+	//                  cho nước tốt nhất ở gốc.
+	//   maximum (cứng): search dừng ngay khi vượt, kiểm tra mỗi TIME_CHECK_NODES nút.
+	class TimeManager {
+	public:
+		void init(const SearchLimits &limits, ui us);
+
+		bool enabled() const { return active; }
+		int optimum() const { return optimumMs; }
+		int maximum() const { return maximumMs; }
+
+		// Gọi sau mỗi vòng hoàn tất; trả về true nếu nên dừng trước vòng kế tiếp.
+		// bestMoveNodeFraction: phần nút ở gốc đã dùng cho nước tốt nhất (0..1).
+		bool stopAfterIteration(int elapsedMs, bool bestMoveChanged, int score, double bestMoveNodeFraction);
+
+	private:
+		bool active = false;
+		bool fixedTime = false; // "go movetime": không co giãn
+		int optimumMs = 0;
+		int maximumMs = 0;
+
+		int stability = 0; // số vòng liên tiếp nước tốt nhất không đổi
+		int previousScore = 0;
+		bool hasPreviousScore = false;
+	};
+}
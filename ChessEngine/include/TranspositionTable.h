@@ -0,0 +1,73 @@
+#pragma once
+#include "Board.h"
+#include <atomic>
+
+namespace ChessEngine {
+
+	enum Bound : ui {
+		BoundNone = 0,
+		BoundUpper = 1, // fail-low: điểm thật <= score
+		BoundLower = 2, // fail-high: điểm thật >= score
+		BoundExact = BoundUpper | BoundLower
+	};
+
+	// TT lưu nguyên Move 16 bit. Khi đọc ra, search vẫn so khớp với danh sách
+	// nước hợp lệ nên một entry trùng key16 không thể đưa nước sai vào doMove.
+	inline uint16_t packMove(const Move &move)
+	{
+		return move.raw();
+	}
+
+	inline bool samePackedMove(uint16_t packed, const Move &move)
+	{
+		return packed != 0 && packed == packMove(move);
+	}
+
+	// Dữ liệu giải nén của một entry
+	struct TTData {
+		uint16_t move = 0;
+		int score = 0;
+		int depth = 0;
+		Bound bound = BoundNone;
+	};
+
+	// Bảng băm chia theo bucket 64 byte (một cache line), mỗi bucket 8 entry.
+	// Mỗi entry là một std::atomic<u64> gói đủ key16/move/score/depth/bound/age,
+	// nên đọc/ghi từ nhiều luồng không cần khóa và không bao giờ bị "xé".
+	class TranspositionTable {
+	public:
+		TranspositionTable();
+		~TranspositionTable();
+
+		void resize(size_t megabytes);
+		void clear();
+		void newSearch(); // tăng age mỗi lần bắt đầu tìm kiếm
+
+		bool probe(u64 key, TTData &data) const;
+		void store(u64 key, uint16_t move, int score, int depth, Bound bound);
+
+		// Phần nghìn số entry thuộc lần tìm kiếm hiện tại (UCI "hashfull")
+		int hashfull() const;
+
+		size_t sizeMB() const { return megabytes; }
+
+	private:
+		static constexpr int EntriesPerBucket = 8;
+		static constexpr int DepthOffset = 16; // cho phép lưu độ sâu âm (qsearch)
+		static constexpr ui AgeMask = 63;
+
+		struct alignas(64) Bucket {
+			std::atomic<u64> entries[EntriesPerBucket];
+		};
+
+		Bucket *bucketFor(u64 key) const;
+		void release();
+
+		Bucket *buckets = nullptr;
+		size_t bucketCount = 0;
+		size_t megabytes = 0;
+		ui age = 0;
+	};
+
+	extern TranspositionTable TT;
+}
@@ -1,5 +1,17 @@
 #pragma once
+#include <iostream>
+#include <string>
 
 namespace UCI {
 
+	// Vòng lặp đọc lệnh UCI từ stdin cho tới "quit" hoặc hết input.
+	// Tìm kiếm chạy trên luồng riêng nên "stop"/"isready" được trả lời ngay.
+	void loop();
+
+	// Thực thi một dòng lệnh; trả về false khi gặp "quit"
+	bool execute(const std::string &line);
+
+	// Gửi "go infinite"/"go ponder" rồi "stop" liền nhau nhiều lần: mỗi lần phải
+	// có đúng một bestmove và stop trả lời ngay (lệnh "ucitest")
+	bool runStopTest(std::ostream &out = std::cout);
 }
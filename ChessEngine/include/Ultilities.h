@@ -26,9 +26,19 @@ namespace ChessEngine {
 	int popcount(const u64& bitboard);
 	int hammingDistance(const u64& obj1, const u64& obj2);
 
+	// Hot-path bit scans (inline vì được gọi trong mọi vòng lặp sinh nước)
+	inline ui lsb(u64 bitboard) { return std::countr_zero(bitboard); }
+	inline ui popLsb(u64& bitboard) {
+		ui sq = std::countr_zero(bitboard);
+		bitboard &= bitboard - 1;
+		return sq;
+	}
+	inline u64 squareBB(ui sq) { return C64(1) << sq; }
+
 	// Debug / utils
 	void printBitboard(const u64& bitboard);
 	int parseEnPassant(const std::string& fenField);
+	std::string squareToString(ui square);
 	ui promotePiece(const ui &pawn, const ui &promo);
 	ui unpromotePiece(const ui& promotedPiece);
 }
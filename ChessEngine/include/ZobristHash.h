@@ -1,4 +1,4 @@
-#pragma once
+﻿#pragma once
 #include "ChessDefinitions.h"
 #include "Ultilities.h"
 
@@ -6,11 +6,31 @@ namespace ChessEngine {
 	struct Zobrist {
 		u64 pieces[12][64];
 		u64 sideToMove;
-		u64 castlingRight[4];
+		u64 castlingRight[16]; // doMove dùng cả mask 0..15 làm chỉ số
 		u64 enPassant[8];
 
 		Zobrist();
 	};
 
 	extern Zobrist zobrist;
+
+	// Bảng cuckoo của mọi nước đi thuận nghịch (quân không phải tốt đi giữa hai ô
+	// trên bàn trống), khóa = pieces[quân][from] ^ pieces[quân][to] ^ sideToMove.
+	// Hiệu zobrist giữa thế hiện tại và một thế cũ nằm trong bảng nghĩa là một
+	// nước đi duy nhất đưa về lại thế cũ (Board::hasUpcomingRepetition).
+	struct Cuckoo {
+		static constexpr ui SIZE = 8192;
+
+		u64 keys[SIZE];
+		uint16_t moves[SIZE]; // from | to << 6 như Move, 0 = ô trống
+		int count;            // số nước đã chèn (3668)
+
+		static ui h1(u64 key) { return ui(key) & (SIZE - 1); }
+		static ui h2(u64 key) { return ui(key >> 16) & (SIZE - 1); }
+
+		// Dựng từ zobrist nên phải khởi tạo sau zobrist (cùng ZobristHash.cpp)
+		Cuckoo();
+	};
+
+	extern Cuckoo cuckoo;
 }
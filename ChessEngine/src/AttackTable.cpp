@@ -1,108 +1,346 @@
 #include "AttackTable.h"
 #include "MagicBitboard.h"
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <vector>
 
-namespace ChessEngine
-{
-    vector2D knightDirection[8] = {
-        {2, 1},
-        {1, 2},
-        {-1, 2},
-        {-2, 1},
-        {-2, -1},
-        {-1, -2},
-        {1, -2},
-        {2, -1}};
-
-    vector2D kingDirection[8] = {
-        {1, 0},
-        {1, 1},
-        {0, 1},
-        {-1, 1},
-        {-1, 0},
-        {-1, -1},
-        {0, -1},
-        {1, -1}};
-}
+// PEXT chỉ có trên x86-64; không cần biên dịch với -mbmi2: hàm dùng lệnh này
+// được biên dịch riêng cho BMI2 và chỉ được gọi khi CPUID báo có
+#if defined(__x86_64__) || defined(_M_X64)
+#define SLIDER_PEXT 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_BMI2
+#else
+#include <cpuid.h>
+#include <immintrin.h>
+#define TARGET_BMI2 __attribute__((target("bmi2")))
+#endif
+#endif
 
 namespace ChessEngine
 {
-    AttackTable Attack; //Bảng tra tấn công
+    namespace
+    {
+        // ::vector2D (ChessDefinitions.h) là constexpr, khác ChessEngine::vector2D
+        constexpr ::vector2D knightDirection[8] = {
+            {2, 1},
+            {1, 2},
+            {-1, 2},
+            {-2, 1},
+            {-2, -1},
+            {-1, -2},
+            {1, -2},
+            {2, -1}};
+
+        constexpr ::vector2D kingDirection[8] = {
+            {1, 0},
+            {1, 1},
+            {0, 1},
+            {-1, 1},
+            {-1, 0},
+            {-1, -1},
+            {0, -1},
+            {1, -1}};
+
+        constexpr void leaperAttackTable(u64 (&Attack)[64], const ::vector2D (&direction)[8])
+        {
+            for (int i = 0; i < 64; i++)
+            {
+                ::vector2D currentSquare(i % 8, i / 8);
+                u64 currentBitboard = 0;
+                for (int j = 0; j < 8; j++)
+                {
+                    ::vector2D sum = currentSquare + direction[j];
+                    if (sum.x >= 0 && sum.y >= 0 && sum.x < 8 && sum.y < 8)
+                        currentBitboard |= C64(1) << (sum.x + 8 * sum.y);
+                }
+                Attack[i] = currentBitboard;
+            }
+        }
+
+        constexpr void knightAttackTable(u64 (&KnightAttack)[64])
+        {
+            leaperAttackTable(KnightAttack, knightDirection);
+        }
+
+        constexpr void kingAttackTable(u64 (&KingAttack)[64])
+        {
+            leaperAttackTable(KingAttack, kingDirection);
+        }
+
+        constexpr void pawnAttackTable(u64 (&PawnAttack)[2][64])
+        {
+            for (int i = 0; i < 64; i++)
+            {
+                int x = i % 8;
+                int y = i / 8;
+
+                // Xử lý cả 2 màu trong một lượt duyệt ô cờ
+                // Trắng: Tiến lên (y + 1)
+                if (y + 1 < 8)
+                {
+                    if (x > 0)
+                        PawnAttack[White][i] |= C64(1) << ((x - 1) + 8 * (y + 1));
+                    if (x < 7)
+                        PawnAttack[White][i] |= C64(1) << ((x + 1) + 8 * (y + 1));
+                }
+
+                // Đen: Lùi xuống (y - 1)
+                if (y - 1 >= 0)
+                {
+                    if (x > 0)
+                        PawnAttack[Black][i] |= C64(1) << ((x - 1) + 8 * (y - 1));
+                    if (x < 7)
+                        PawnAttack[Black][i] |= C64(1) << ((x + 1) + 8 * (y - 1));
+                }
+            }
+        }
+
+        constexpr void betweenTable(u64 (&Between)[64][64])
+        {
+            for (int a = 0; a < 64; a++)
+            {
+                for (int b = 0; b < 64; b++)
+                {
+                    u64 aBB = C64(1) << a;
+                    u64 bBB = C64(1) << b;
+                    if (getRookAttack(a, 0) & bBB)
+                        Between[a][b] = getRookAttack(a, bBB) & getRookAttack(b, aBB);
+                    else if (getBishopAttack(a, 0) & bBB)
+                        Between[a][b] = getBishopAttack(a, bBB) & getBishopAttack(b, aBB);
+                    else
+                        Between[a][b] = 0;
+                }
+            }
+        }
+
+        constexpr void lineTable(u64 (&Line)[64][64])
+        {
+            for (int a = 0; a < 64; a++)
+            {
+                for (int b = 0; b < 64; b++)
+                {
+                    u64 aBB = C64(1) << a;
+                    u64 bBB = C64(1) << b;
+                    if (getRookAttack(a, 0) & bBB)
+                        Line[a][b] = (getRookAttack(a, 0) & getRookAttack(b, 0)) | aBB | bBB;
+                    else if (getBishopAttack(a, 0) & bBB)
+                        Line[a][b] = (getBishopAttack(a, 0) & getBishopAttack(b, 0)) | aBB | bBB;
+                    else
+                        Line[a][b] = 0;
+                }
+            }
+        }
+
+        // Bảng magic duyệt tập con theo rookMask/bishopMask: phải khớp với mặt nạ tính lại
+        constexpr bool blockerMasksMatch()
+        {
+            for (ui square = 0; square < 64; square++)
+                if (rookBlockerMask(square) != rookMask[square] || bishopBlockerMask(square) != bishopMask[square])
+                    return false;
+            return true;
+        }
+        static_assert(blockerMasksMatch(), "rookMask/bishopMask do not match the blocker masks");
+
+        // Chỉ số PEXT dùng chung bố cục magic: cần 64 - shift == số bit của mặt nạ
+        constexpr bool shiftsMatchMasks()
+        {
+            for (ui square = 0; square < 64; square++)
+                if (64 - rookShift[square] != std::popcount(rookMask[square])
+                    || 64 - bishopShift[square] != std::popcount(bishopMask[square]))
+                    return false;
+            return true;
+        }
+        static_assert(shiftsMatchMasks(), "slider table layout cannot be shared with PEXT indices");
 
-    AttackTable::AttackTable()
+#if defined(SLIDER_PEXT)
+        // Family của CPU theo CPUID leaf 1 (gồm extended family)
+        ui cpuFamily(ui leaf1Eax)
+        {
+            ui family = (leaf1Eax >> 8) & 0xF;
+            return family == 0xF ? family + ((leaf1Eax >> 20) & 0xFF) : family;
+        }
+
+        struct CpuInfo
+        {
+            bool bmi2 = false;
+            bool slowPext = false; // PEXT chạy bằng microcode
+        };
+
+        CpuInfo readCpuInfo()
+        {
+            CpuInfo cpu;
+            ui regs[4] = {}; // eax, ebx, ecx, edx
+            char vendor[13] = {};
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            std::memcpy(regs, info, sizeof(regs));
+#else
+            __cpuid(0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+            if (regs[0] < 7)
+                return cpu;
+            std::memcpy(vendor, &regs[1], 4);
+            std::memcpy(vendor + 4, &regs[3], 4);
+            std::memcpy(vendor + 8, &regs[2], 4);
+
+#if defined(_MSC_VER)
+            __cpuidex(info, 7, 0);
+            cpu.bmi2 = info[1] & (1 << 8);
+            __cpuid(info, 1);
+            ui family = cpuFamily(ui(info[0]));
+#else
+            __cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+            cpu.bmi2 = regs[1] & (1 << 8);
+            __cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+            ui family = cpuFamily(regs[0]);
+#endif
+            // Zen 1/2 (family 0x17) và các đời AMD cũ: PEXT chậm hơn magic nhiều lần
+            cpu.slowPext = std::strcmp(vendor, "AuthenticAMD") == 0 && family < 0x19;
+            return cpu;
+        }
+
+        // Bảng PEXT cùng bố cục với Attack.sliders, dựng lúc khởi động khi cần.
+        // Nằm trong .bss: không làm to file thực thi, không chiếm RAM nếu không dùng
+        u64 pextSliders[SLIDER_TABLE_SIZE];
+        bool pextSlidersReady = false;
+
+        TARGET_BMI2 u64 pextIndex(u64 occupancy, u64 mask, u64, int)
+        {
+            return _pext_u64(occupancy, mask);
+        }
+
+        TARGET_BMI2 u64 pextRookAttacks(ui square, u64 occupancy)
+        {
+            return pextSliders[sliderLayout.rookOffset[square] + _pext_u64(occupancy, rookMask[square])];
+        }
+
+        TARGET_BMI2 u64 pextBishopAttacks(ui square, u64 occupancy)
+        {
+            return pextSliders[sliderLayout.bishopOffset[square] + _pext_u64(occupancy, bishopMask[square])];
+        }
+
+        // Chỉ gọi khi CPU có BMI2, lúc chưa có luồng tìm kiếm nào chạy
+        void buildPextSliders()
+        {
+            if (pextSlidersReady)
+                return;
+            sliderTable(pextSliders, pextIndex);
+            pextSlidersReady = true;
+        }
+#endif
+    }
+
+    constexpr AttackTable::AttackTable()
+        : pawnAttack{}, kingAttack{}, knightAttack{}, sliders{}, betweenSquares{}, lineSquares{}
     {
-        rookAttackTable(rookAttack);
-        bishopAttackTable(bishopAttack);
+        sliderTable(sliders, magicIndex);
         knightAttackTable(knightAttack);
         kingAttackTable(kingAttack);
         pawnAttackTable(pawnAttack);
+        betweenTable(betweenSquares);
+        lineTable(lineSquares);
     }
+
+    // constinit: lỗi biên dịch nếu bảng không thể tính xong lúc biên dịch
+    constinit const AttackTable Attack; //Bảng tra tấn công
 }
 
 namespace ChessEngine
 {
-    void knightAttackTable(u64 (&KnightAttack)[64])
+    constinit SliderLookup sliderLookup{ magicRookAttacks, magicBishopAttacks, SliderBackend::Magic };
+
+    namespace
     {
-        for (int i = 0; i < 64; i++)
+        // Chọn backend một lần lúc khởi động (khởi tạo động của file này)
+        bool selectSliderBackend()
         {
-            vector2D currentSquare(i % 8, i / 8);
-            u64 currentBitboard = 0;
-            for (int j = 0; j < 8; j++)
+#if defined(SLIDER_PEXT)
+            if (detectSliderBackend() == SliderBackend::Pext)
             {
-                vector2D sum = currentSquare + ChessEngine::knightDirection[j];
-                if (sum.x >= 0 && sum.y >= 0 && sum.x < 8 && sum.y < 8)
-                {
-                    ChessEngine::setBit(currentBitboard, sum.x + 8 * sum.y);
-                }
+                buildPextSliders();
+                sliderLookup = { pextRookAttacks, pextBishopAttacks, SliderBackend::Pext };
             }
-            KnightAttack[i] = currentBitboard;
+#endif
+            return true;
         }
+
+        const bool sliderBackendSelected = selectSliderBackend();
+    }
+
+    SliderBackend detectSliderBackend()
+    {
+#if defined(SLIDER_PEXT)
+        CpuInfo cpu = readCpuInfo();
+        if (cpu.bmi2 && !cpu.slowPext)
+            return SliderBackend::Pext;
+#endif
+        return SliderBackend::Magic;
     }
 
-    void pawnAttackTable(u64 (&PawnAttack)[2][64])
+    const char *sliderBackendName(SliderBackend backend)
     {
-        memset(PawnAttack, 0, sizeof(PawnAttack));
+        return backend == SliderBackend::Pext ? "pext" : "magic";
+    }
 
-        for (int i = 0; i < 64; i++)
+    void runSliderBench(std::ostream &out)
+    {
+        // Occupancy thưa như trong ván cờ thật: AND của 2 số ngẫu nhiên (~25% ô có quân)
+        constexpr int Samples = 1 << 16;
+        constexpr int Rounds = 200;
+        std::mt19937_64 rng(2024);
+        std::vector<std::pair<ui, u64>> samples(Samples);
+        for (auto &[square, occupancy] : samples)
         {
-            int x = i % 8;
-            int y = i / 8;
+            square = ui(rng() % 64);
+            occupancy = rng() & rng();
+        }
 
-            // Xử lý cả 2 màu trong một lượt duyệt ô cờ
-            // Trắng: Tiến lên (y + 1)
-            if (y + 1 < 8)
-            {
-                if (x > 0)
-                    ChessEngine::setBit(PawnAttack[White][i], (x - 1) + 8 * (y + 1));
-                if (x < 7)
-                    ChessEngine::setBit(PawnAttack[White][i], (x + 1) + 8 * (y + 1));
-            }
+        out << "Slider table " << SLIDER_TABLE_SIZE * sizeof(u64) / 1024 << " KB, using "
+            << sliderBackendName(sliderLookup.backend) << " (this CPU prefers "
+            << sliderBackendName(detectSliderBackend()) << ")\n";
 
-            // Đen: Lùi xuống (y - 1)
-            if (y - 1 >= 0)
-            {
-                if (x > 0)
-                    ChessEngine::setBit(PawnAttack[Black][i], (x - 1) + 8 * (y - 1));
-                if (x < 7)
-                    ChessEngine::setBit(PawnAttack[Black][i], (x + 1) + 8 * (y - 1));
-            }
+        // Mọi backend CPU chạy được, gọi qua con trỏ hàm như khi tìm kiếm
+        std::vector<SliderLookup> backends = { { magicRookAttacks, magicBishopAttacks, SliderBackend::Magic } };
+#if defined(SLIDER_PEXT)
+        if (readCpuInfo().bmi2)
+        {
+            buildPextSliders();
+            backends.push_back({ pextRookAttacks, pextBishopAttacks, SliderBackend::Pext });
         }
-    }
+#endif
+        if (backends.size() == 1)
+            out << "pext    not supported by this CPU\n";
 
-    void kingAttackTable(u64 (&KingAttack)[64])
-    {
-        for (int i = 0; i < 64; i++)
+        for (const SliderLookup &backend : backends)
         {
-            vector2D currentSquare(i % 8, i / 8);
-            u64 currentBitboard = 0;
-            for (int j = 0; j < 8; j++)
-            {
-                vector2D sum = currentSquare + kingDirection[j];
-                if (sum.x >= 0 && sum.y >= 0 && sum.x < 8 && sum.y < 8)
-                {
-                    ChessEngine::setBit(currentBitboard, sum.x + 8 * sum.y);
-                }
-            }
-            KingAttack[i] = currentBitboard;
+            // Đối chiếu với cách tính tia trực tiếp trước khi đo
+            int mismatches = 0;
+            for (const auto &[square, occupancy] : samples)
+                if (backend.rook(square, occupancy) != getRookAttack(square, occupancy)
+                    || backend.bishop(square, occupancy) != getBishopAttack(square, occupancy))
+                    mismatches++;
+
+            u64 checksum = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int round = 0; round < Rounds; round++)
+                for (const auto &[square, occupancy] : samples)
+                    checksum += backend.rook(square, occupancy ^ checksum) ^ backend.bishop(square, occupancy);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            double lookups = 2.0 * Rounds * Samples;
+
+            out << std::left << std::setw(6) << sliderBackendName(backend.backend) << std::right
+                << "  lookups " << u64(lookups)
+                << "  time " << std::fixed << std::setprecision(3) << seconds << "s"
+                << "  ns/lookup " << std::setprecision(2) << seconds * 1e9 / lookups
+                << "  checksum " << checksum;
+            out.unsetf(std::ios::fixed);
+            if (mismatches)
+                out << "  MISMATCHES " << mismatches;
+            out << "\n";
         }
     }
-}
\ No newline at end of file
+}
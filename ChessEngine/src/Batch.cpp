@@ -0,0 +1,632 @@
+#include "Batch.h"
+#include "MoveGenerator.h"
+#include "TranspositionTable.h"
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace ChessEngine
+{
+    namespace
+    {
+        const char *StartFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+        // Một thế cần phân tích. Thế được dựng lại từ startFen + moves để giữ
+        // lịch sử cho luật lặp; moves chỉ tính từ nước "về 0" gần nhất nên ngắn.
+        struct BatchJob {
+            u64 index = 0;
+            std::string startFen;
+            std::vector<Move> moves;
+            std::string fen; // thế cần phân tích, ghi ra kết quả
+            std::string id;  // opcode "id" của EPD
+
+            // PGN: ván thứ game (từ 1), số ply đã đi, nước đã đi trong ván
+            u64 game = 0;
+            int ply = 0;
+            std::string played;
+            Move playedMove;
+
+            std::string error; // dòng không đọc được: chỉ ghi lỗi
+        };
+
+        double secondsSince(std::chrono::steady_clock::time_point start)
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        std::string jsonString(const std::string &text)
+        {
+            std::string result = "\"";
+            for (char c : text)
+            {
+                if (c == '"' || c == '\\')
+                    result += '\\';
+                if ((unsigned char)c < 0x20)
+                {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    result += escaped;
+                    continue;
+                }
+                result += c;
+            }
+            return result + "\"";
+        }
+
+        std::string trim(const std::string &text)
+        {
+            size_t first = text.find_first_not_of(" \t\r\n");
+            if (first == std::string::npos)
+                return "";
+            size_t last = text.find_last_not_of(" \t\r\n");
+            return text.substr(first, last - first + 1);
+        }
+
+        bool isNumber(const std::string &text)
+        {
+            return !text.empty() && text.find_first_not_of("0123456789") == std::string::npos;
+        }
+
+        // Kiểm tra bốn trường đầu của FEN trước khi dựng Board (Board không
+        // tự kiểm tra). Trả về mô tả lỗi, rỗng nếu hợp lệ.
+        std::string fenError(const std::string &placement, const std::string &side,
+            const std::string &castling, const std::string &enPassant)
+        {
+            int ranks = 0, kings[2] = { 0, 0 };
+            std::istringstream rows(placement);
+            std::string row;
+            while (std::getline(rows, row, '/'))
+            {
+                if (++ranks > 8)
+                    return "too many ranks";
+                int files = 0;
+                for (char c : row)
+                {
+                    if (c >= '1' && c <= '8')
+                        files += c - '0';
+                    else if (std::string("pnbrqkPNBRQK").find(c) != std::string::npos)
+                    {
+                        files++;
+                        if ((c == 'p' || c == 'P') && (ranks == 1 || ranks == 8))
+                            return "pawn on first or last rank";
+                        if (c == 'k' || c == 'K')
+                            kings[c == 'K']++;
+                    }
+                    else
+                        return std::string("bad piece '") + c + "'";
+                }
+                if (files != 8)
+                    return "rank " + std::to_string(9 - ranks) + " does not have 8 squares";
+            }
+            if (ranks != 8)
+                return "expected 8 ranks";
+            if (kings[White] != 1 || kings[Black] != 1)
+                return "each side needs exactly one king";
+            if (side != "w" && side != "b")
+                return "bad side to move";
+            if (castling != "-" && castling.find_first_not_of("KQkq") != std::string::npos)
+                return "bad castling field";
+            if (enPassant != "-" && (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h'
+                || (enPassant[1] != '3' && enPassant[1] != '6')))
+                return "bad en passant field";
+            return "";
+        }
+
+        // Dòng EPD ("<4 trường> [opcode ...;]...") hoặc FEN đầy đủ
+        BatchJob parseEpdLine(const std::string &line)
+        {
+            BatchJob job;
+            std::istringstream input(line);
+            std::string fields[4];
+            for (std::string &field : fields)
+                input >> field;
+            job.error = fenError(fields[0], fields[1], fields[2], fields[3]);
+            if (fields[3].empty())
+                job.error = "expected at least 4 FEN fields";
+            if (!job.error.empty())
+            {
+                job.fen = line;
+                return job;
+            }
+
+            std::string fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3];
+            std::string rest;
+            std::getline(input, rest);
+
+            // Hai số tiếp theo (nếu có) là đồng hồ của FEN, còn lại là opcode EPD
+            std::istringstream clocks(rest);
+            std::string halfMove, fullMove;
+            clocks >> halfMove >> fullMove;
+            if (isNumber(halfMove) && isNumber(fullMove))
+            {
+                fen += " " + halfMove + " " + fullMove;
+                std::getline(clocks, rest);
+            }
+
+            std::istringstream operations(rest);
+            std::string operation;
+            while (std::getline(operations, operation, ';'))
+            {
+                std::istringstream tokens(operation);
+                std::string opcode;
+                tokens >> opcode;
+                if (opcode != "id")
+                    continue;
+                std::string operand = trim(operation.substr(operation.find("id") + 2));
+                if (operand.size() >= 2 && operand.front() == '"' && operand.back() == '"')
+                    operand = operand.substr(1, operand.size() - 2);
+                job.id = operand;
+            }
+
+            job.startFen = fen;
+            job.fen = fen;
+            return job;
+        }
+
+        // Đọc PGN theo luồng: không giữ cả ván, mỗi nước đọc được sinh ngay một
+        // việc cho thế trước nước đó
+        class PgnReader {
+        public:
+            explicit PgnReader(std::function<void(BatchJob &&)> emitJob) : emit(std::move(emitJob)) {}
+
+            void readLine(const std::string &line)
+            {
+                if (!inComment)
+                {
+                    std::string text = trim(line);
+                    if (!text.empty() && text[0] == '%')
+                        return; // dòng escape
+                    if (!text.empty() && text[0] == '[')
+                    {
+                        readTag(text);
+                        return;
+                    }
+                }
+
+                for (size_t i = 0; i < line.size(); i++)
+                {
+                    char c = line[i];
+                    if (inComment)
+                    {
+                        inComment = c != '}';
+                        continue;
+                    }
+                    if (c == '{')
+                        inComment = true;
+                    else if (c == ';')
+                        break; // chú thích tới cuối dòng
+                    else if (c == '(')
+                        variationDepth++;
+                    else if (c == ')')
+                        variationDepth = std::max(0, variationDepth - 1);
+                    else if (!std::isspace((unsigned char)c))
+                    {
+                        size_t end = line.find_first_of(" \t\r\n{};()", i);
+                        if (end == std::string::npos)
+                            end = line.size();
+                        readToken(line.substr(i, end - i));
+                        i = end - 1;
+                    }
+                }
+            }
+
+        private:
+            void readTag(const std::string &text)
+            {
+                // Tag sau phần nước đi là bắt đầu ván mới (ván trước thiếu kết quả)
+                if (inGame)
+                    endGame();
+                std::istringstream tag(text.substr(1));
+                std::string name;
+                tag >> name;
+                size_t open = text.find('"'), close = text.rfind('"');
+                std::string value = open != close ? text.substr(open + 1, close - open - 1) : "";
+                if (name == "FEN")
+                    tagFen = value;
+            }
+
+            void readToken(std::string token)
+            {
+                if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*")
+                {
+                    if (variationDepth == 0)
+                        endGame();
+                    return;
+                }
+                if (variationDepth > 0 || token[0] == '$')
+                    return;
+
+                // Số thứ tự nước: "12." "12..." hoặc dính liền "12.e4"; chỉ bỏ chữ
+                // số khi có dấu chấm theo sau để giữ nhập thành viết "0-0"
+                size_t digitsEnd = token.find_first_not_of("0123456789");
+                if (digitsEnd == std::string::npos)
+                    return;
+                if (digitsEnd > 0 && token[digitsEnd] == '.')
+                {
+                    size_t moveStart = token.find_first_not_of('.', digitsEnd);
+                    if (moveStart == std::string::npos)
+                        return;
+                    token = token.substr(moveStart);
+                }
+
+                // Nhập thành viết bằng số không: "0-0", "0-0-0"
+                if (token.rfind("0-0-0", 0) == 0)
+                    token.replace(0, 5, "O-O-O");
+                else if (token.rfind("0-0", 0) == 0)
+                    token.replace(0, 3, "O-O");
+
+                if (!inGame)
+                    startGame();
+                if (skipGame)
+                    return;
+
+                Move move = parseSan(*board, token);
+                BatchJob job;
+                job.game = gameNumber;
+                job.ply = ply;
+                job.played = token.substr(0, token.find_last_not_of("!?") + 1);
+                job.fen = board->toFen();
+                if (move.isNone())
+                {
+                    job.error = "illegal or ambiguous move " + token;
+                    skipGame = true; // phần còn lại của ván không còn nghĩa
+                    emit(std::move(job));
+                    return;
+                }
+                job.startFen = anchorFen;
+                job.moves = moves;
+                job.playedMove = move;
+                emit(std::move(job));
+
+                if (board->ply >= MAX_PLY - 1)
+                    board->trimHistory();
+                board->doMove(move);
+                ply++;
+                // Nước về 0 cắt đứt mọi lần lặp: thế sau nó là điểm neo mới
+                if (board->st->halfMove == 0)
+                {
+                    anchorFen = board->toFen();
+                    moves.clear();
+                }
+                else
+                    moves.push_back(move);
+            }
+
+            void startGame()
+            {
+                inGame = true;
+                skipGame = false;
+                gameNumber++;
+                ply = 0;
+                moves.clear();
+                anchorFen = tagFen.empty() ? StartFen : tagFen;
+                std::istringstream fen(anchorFen);
+                std::string fields[4];
+                for (std::string &field : fields)
+                    fen >> field;
+                std::string error = fenError(fields[0], fields[1], fields[2], fields[3]);
+                if (fields[3].empty())
+                    error = "expected at least 4 FEN fields";
+                if (!error.empty())
+                {
+                    BatchJob job;
+                    job.game = gameNumber;
+                    job.fen = anchorFen;
+                    job.error = "bad FEN tag: " + error;
+                    skipGame = true;
+                    emit(std::move(job));
+                    return;
+                }
+                board = std::make_unique<Board>(Fen(anchorFen));
+            }
+
+            void endGame()
+            {
+                inGame = false;
+                variationDepth = 0;
+                tagFen.clear();
+            }
+
+            std::function<void(BatchJob &&)> emit;
+            std::unique_ptr<Board> board;
+            std::string tagFen;
+            std::string anchorFen;
+            std::vector<Move> moves;
+            u64 gameNumber = 0;
+            int ply = 0;
+            int variationDepth = 0;
+            bool inComment = false;
+            bool inGame = false;
+            bool skipGame = false;
+        };
+
+        std::string resultLine(const BatchJob &job, const SearchInfo *info)
+        {
+            std::ostringstream line;
+            line << "{\"index\":" << job.index;
+            if (job.game)
+                line << ",\"game\":" << job.game << ",\"ply\":" << job.ply;
+            line << ",\"fen\":" << jsonString(job.fen);
+            if (!job.id.empty())
+                line << ",\"id\":" << jsonString(job.id);
+            if (!job.played.empty())
+            {
+                line << ",\"played\":" << jsonString(job.played);
+                if (!job.playedMove.isNone())
+                    line << ",\"playedUci\":\"" << moveToString(job.playedMove) << "\"";
+            }
+            if (!job.error.empty())
+                return line.str() + ",\"error\":" + jsonString(job.error) + "}";
+
+            // Điểm theo góc nhìn bên đi, cùng quy ước "cp"/"mate" với UCI
+            std::string score = scoreToString(info->score);
+            size_t space = score.find(' ');
+            line << ",\"depth\":" << info->depth
+                 << ",\"score\":{\"" << score.substr(0, space) << "\":" << score.substr(space + 1) << "}"
+                 << ",\"bestmove\":";
+            if (info->bestMove.isNone())
+                line << "null";
+            else
+                line << "\"" << moveToString(info->bestMove) << "\"";
+            line << ",\"pv\":[";
+            for (size_t i = 0; i < info->pv.size(); i++)
+                line << (i ? "," : "") << "\"" << moveToString(info->pv[i]) << "\"";
+            line << "],\"nodes\":" << info->nodes << ",\"timeMs\":" << info->timeMs << "}";
+            return line.str();
+        }
+
+        // Mỗi luồng một hàng đợi: chủ hàng lấy từ đầu, luồng rảnh lấy trộm từ cuối
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<BatchJob> jobs;
+        };
+
+        class BatchPool {
+        public:
+            BatchPool(std::ostream &output, const BatchOptions &batchOptions)
+                : out(output), options(batchOptions), queues(std::max(1, batchOptions.threads))
+            {
+                int threads = int(queues.size());
+                window = options.window ? options.window : size_t(64) * threads;
+                report.workerPositions.assign(threads, 0);
+                report.workerBusy.assign(threads, 0.0);
+                report.workerSteals.assign(threads, 0);
+                workerNodes.assign(threads, 0);
+                for (int id = 0; id < threads; id++)
+                    workers.emplace_back([this, id] { work(id); });
+            }
+
+            // Chặn khi đã có window thế chưa ghi ra
+            void push(BatchJob &&job)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(outputMutex);
+                    spaceAvailable.wait(lock, [this] { return inFlight < window; });
+                    inFlight++;
+                }
+                job.index = nextIndex++;
+                WorkerQueue &queue = queues[job.index % queues.size()];
+                {
+                    std::lock_guard<std::mutex> lock(queue.mutex);
+                    queue.jobs.push_back(std::move(job));
+                }
+                {
+                    std::lock_guard<std::mutex> lock(poolMutex);
+                    queued++;
+                }
+                workAvailable.notify_one();
+            }
+
+            BatchReport finish()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(poolMutex);
+                    finished = true;
+                }
+                workAvailable.notify_all();
+                for (std::thread &worker : workers)
+                    worker.join();
+                report.positions = nextIndex;
+                for (u64 nodes : workerNodes)
+                    report.nodes += nodes;
+                return report;
+            }
+
+        private:
+            bool takeJob(int id, BatchJob &job)
+            {
+                int threads = int(queues.size());
+                for (int i = 0; i < threads; i++)
+                {
+                    WorkerQueue &queue = queues[(id + i) % threads];
+                    std::lock_guard<std::mutex> lock(queue.mutex);
+                    if (queue.jobs.empty())
+                        continue;
+                    if (i == 0)
+                    {
+                        job = std::move(queue.jobs.front());
+                        queue.jobs.pop_front();
+                    }
+                    else
+                    {
+                        job = std::move(queue.jobs.back());
+                        queue.jobs.pop_back();
+                        report.workerSteals[id]++;
+                    }
+                    return true;
+                }
+                return false;
+            }
+
+            void work(int id)
+            {
+                // Giữ qua các thế: chỉ SearchShared và PawnTable, còn Board và
+                // Searcher dựng mới cho mỗi thế như SearchPool::think
+                SearchShared shared;
+                auto pawns = std::make_unique<PawnTable>();
+
+                while (true)
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(poolMutex);
+                        workAvailable.wait(lock, [this] { return queued > 0 || finished; });
+                        if (queued == 0)
+                            return;
+                        queued--;
+                    }
+                    // queued đếm đúng số việc trong các hàng đợi nên chắc chắn lấy được
+                    BatchJob job;
+                    while (!takeJob(id, job))
+                        std::this_thread::yield();
+
+                    auto start = std::chrono::steady_clock::now();
+                    std::string line;
+                    if (job.error.empty())
+                    {
+                        auto board = std::make_unique<Board>(Fen(job.startFen));
+                        for (const Move &move : job.moves)
+                        {
+                            if (board->ply >= MAX_PLY - 1)
+                                board->trimHistory();
+                            board->doMove(move);
+                        }
+                        if (board->ply + MAX_SEARCH_PLY >= MAX_PLY)
+                            board->trimHistory();
+
+                        // Bên vừa đi không được để vua bị chiếu
+                        ui them = board->st->activeColor ^ 1;
+                        if (board->attackersTo(board->kingSquare(them), board->occupancy()) & board->colorPieces(board->st->activeColor))
+                            job.error = "side not to move is in check";
+                        else
+                        {
+                            shared.stop = false;
+                            shared.nodes = 0;
+                            auto searcher = std::make_unique<Searcher>(*board, &shared, 0, pawns.get());
+                            SearchInfo info = searcher->think(options.limits);
+                            workerNodes[id] += info.nodes;
+                            line = resultLine(job, &info);
+                        }
+                    }
+                    if (!job.error.empty())
+                        line = resultLine(job, nullptr);
+                    report.workerBusy[id] += secondsSince(start);
+                    report.workerPositions[id]++;
+                    write(job, line);
+                }
+            }
+
+            // Bộ đệm sắp xếp lại: ghi ngay khi đủ các thế đứng trước
+            void write(const BatchJob &job, std::string &line)
+            {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                if (!job.error.empty())
+                    report.errors++;
+                pending.emplace(job.index, std::move(line));
+                size_t written = 0;
+                for (auto it = pending.begin(); it != pending.end() && it->first == nextToWrite; it = pending.erase(it))
+                {
+                    out << it->second << "\n";
+                    nextToWrite++;
+                    written++;
+                }
+                if (written)
+                {
+                    out.flush();
+                    inFlight -= written;
+                    spaceAvailable.notify_one();
+                }
+            }
+
+            std::ostream &out;
+            const BatchOptions &options;
+            std::vector<WorkerQueue> queues;
+            std::vector<std::thread> workers;
+            std::vector<u64> workerNodes;
+            BatchReport report;
+
+            u64 nextIndex = 0; // chỉ luồng đọc dùng
+
+            std::mutex poolMutex;
+            std::condition_variable workAvailable;
+            u64 queued = 0;
+            bool finished = false;
+
+            std::mutex outputMutex;
+            std::condition_variable spaceAvailable;
+            size_t window = 0;
+            size_t inFlight = 0;
+            u64 nextToWrite = 0;
+            std::map<u64, std::string> pending;
+        };
+    }
+
+    double BatchReport::scaling() const
+    {
+        double busy = 0;
+        for (double seconds : workerBusy)
+            busy += seconds;
+        return seconds > 0 ? busy / seconds : 0.0;
+    }
+
+    BatchReport runBatch(std::istream &in, std::ostream &out, const BatchOptions &options)
+    {
+        auto start = std::chrono::steady_clock::now();
+        TT.newSearch();
+
+        BatchPool pool(out, options);
+        PgnReader pgn([&pool](BatchJob &&job) { pool.push(std::move(job)); });
+
+        enum { Unknown, Epd, Pgn } format = Unknown;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (format == Unknown)
+            {
+                std::string text = trim(line);
+                if (text.empty() || text[0] == '#')
+                    continue;
+                format = text[0] == '[' ? Pgn : Epd;
+            }
+
+            if (format == Pgn)
+            {
+                pgn.readLine(line);
+                continue;
+            }
+            std::string text = trim(line);
+            if (text.empty() || text[0] == '#')
+                continue;
+            pool.push(parseEpdLine(text));
+        }
+
+        BatchReport report = pool.finish();
+        report.seconds = secondsSince(start);
+        return report;
+    }
+
+    void printBatchReport(const BatchReport &report, std::ostream &out)
+    {
+        for (size_t i = 0; i < report.workerPositions.size(); i++)
+        {
+            double utilisation = report.seconds > 0 ? 100.0 * report.workerBusy[i] / report.seconds : 0.0;
+            out << "Worker " << i << ": " << report.workerPositions[i] << " positions, busy "
+                << std::fixed << std::setprecision(3) << report.workerBusy[i] << "s ("
+                << std::setprecision(1) << utilisation << "%), " << report.workerSteals[i] << " stolen\n";
+        }
+        u64 nps = report.seconds > 0 ? u64(report.nodes / report.seconds) : report.nodes;
+        out << "Positions: " << report.positions << "  Errors: " << report.errors
+            << "  Time: " << std::setprecision(3) << report.seconds << "s"
+            << "  Positions/s: " << std::setprecision(1) << report.positionsPerSecond()
+            << "  Nodes: " << report.nodes << "  NPS: " << nps
+            << "  Scaling: " << std::setprecision(2) << report.scaling() << "x\n";
+        out.unsetf(std::ios::fixed);
+    }
+}
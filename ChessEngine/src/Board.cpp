@@ -1,5 +1,10 @@
 ﻿#include "Board.h"
 #include "Ultilities.h"
+#include "AttackTable.h"
+#include "PSQT.h"
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
 
 ChessEngine::Fen::Fen(const std::string& FEN)
 {
@@ -14,10 +19,20 @@ ChessEngine::Fen::Fen(const std::string& FEN)
 	else whiteTurn = false;
 }
 
+std::string ChessEngine::moveToString(const Move& move)
+{
+	if (move.isNone()) return "0000";
+	std::string result = squareToString(move.from()) + squareToString(move.to());
+	if (move.isPromotion()) {
+		const char promoChar[5] = { ' ', 'n', 'b', 'r', 'q' };
+		result += promoChar[move.promotionType()];
+	}
+	return result;
+}
 
 ChessEngine::Board::Board(const Fen& fen) {
 	for (size_t i = 0; i < 13; i++) {
-		pieces[i] = NoPiece;
+		pieces[i] = Empty;
 	}
 	for (size_t i = 0; i < 64; i++) {
 		piecesList[i] = NoPiece;
@@ -30,6 +45,48 @@ ChessEngine::Board::Board(const Fen& fen) {
 	initStateFromFen(fen);
 }
 
+ChessEngine::Board::Board(const Board& other) {
+	*this = other;
+}
+
+ChessEngine::Board& ChessEngine::Board::operator=(const Board& other) {
+	if (this == &other) return *this;
+
+	std::memcpy(pieces, other.pieces, sizeof(pieces));
+	std::memcpy(piecesList, other.piecesList, sizeof(piecesList));
+	ply = other.ply;
+	std::copy(other.stateStack.begin(), other.stateStack.begin() + ply + 1, stateStack.begin());
+
+	// Nối lại chuỗi previous vào stack của bản sao
+	stateStack[0].previous = nullptr;
+	for (ui i = 1; i <= ply; i++)
+		stateStack[i].previous = &stateStack[i - 1];
+	st = &stateStack[ply];
+
+	// Accumulator không được chép, tính lại khi cần
+	invalidateAccumulators(ply);
+	return *this;
+}
+
+void ChessEngine::Board::trimHistory(ui keep) {
+	if (ply <= keep) return;
+
+	std::copy(stateStack.begin() + (ply - keep), stateStack.begin() + ply + 1, stateStack.begin());
+	ply = keep;
+	stateStack[0].previous = nullptr;
+	for (ui i = 1; i <= ply; i++)
+		stateStack[i].previous = &stateStack[i - 1];
+	st = &stateStack[ply];
+
+	invalidateAccumulators(ply);
+}
+
+void ChessEngine::Board::invalidateAccumulators(ui lastPly) {
+	if (!accumulators) return;
+	for (ui i = 0; i <= lastPly; i++)
+		(*accumulators)[i].computed = false;
+}
+
 //rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR
 
 void ChessEngine::Board::initBitboardAndList(const Fen& fen)
@@ -92,10 +149,17 @@ void ChessEngine::Board::initStateFromFen(const Fen& fen)
 
 	// Zobrist
 	s.zobristKey = computeZobrist(s);
+	s.pawnKey = computePawnKey();
 
-	// Init others
+	// PSQT và phase: tính đầy đủ một lần, sau đó doMove cập nhật tăng dần
 	s.phaseValue = 0;
 	s.psqtValue.fill(0);
+	for (int sq = 0; sq < 64; sq++) {
+		ui piece = piecesList[sq];
+		if (piece == NoPiece) continue;
+		s.phaseValue += piecePhase[piece];
+		s.psqtValue[piece] += psqt.value[piece][sq];
+	}
 
 	s.previous = nullptr;
 }
@@ -117,11 +181,8 @@ u64 ChessEngine::Board::computeZobrist(const StateInfo& s) const
 		key ^= zobrist.enPassant[s.enPassant % 8];
 	}
 
-	// Castling
-	if (s.castling & 1) key ^= zobrist.castlingRight[0];
-	if (s.castling & 2) key ^= zobrist.castlingRight[1];
-	if (s.castling & 4) key ^= zobrist.castlingRight[2];
-	if (s.castling & 8) key ^= zobrist.castlingRight[3];
+	// Castling: một khóa cho mỗi mask 0..15, giống hệt doMove
+	key ^= zobrist.castlingRight[s.castling & 15];
 
 	// Side to move
 	if (s.activeColor == Black)
@@ -130,6 +191,154 @@ u64 ChessEngine::Board::computeZobrist(const StateInfo& s) const
 	return key;
 }
 
+u64 ChessEngine::Board::computePawnKey() const
+{
+	u64 key = 0;
+	for (ui piece : { WhitePawn, BlackPawn }) {
+		u64 pawns = pieces[piece];
+		while (pawns)
+			key ^= zobrist.pieces[piece][popLsb(pawns)];
+	}
+	return key;
+}
+
+
+u64 ChessEngine::Board::colorPieces(ui color) const
+{
+	if (color == White)
+		return pieces[WhitePawn] | pieces[WhiteKnight] | pieces[WhiteBishop]
+			| pieces[WhiteRook] | pieces[WhiteQueen] | pieces[WhiteKing];
+	return pieces[BlackPawn] | pieces[BlackKnight] | pieces[BlackBishop]
+		| pieces[BlackRook] | pieces[BlackQueen] | pieces[BlackKing];
+}
+
+u64 ChessEngine::Board::occupancy() const
+{
+	return colorPieces(White) | colorPieces(Black);
+}
+
+ui ChessEngine::Board::kingSquare(ui color) const
+{
+	return lsb(pieces[makePiece(color, King)]);
+}
+
+// Tất cả quân (cả 2 bên) đang tấn công ô square với occupancy cho trước
+u64 ChessEngine::Board::attackersTo(ui square, u64 occupied) const
+{
+	return (Attack.pawnAttack[Black][square] & pieces[WhitePawn])
+		| (Attack.pawnAttack[White][square] & pieces[BlackPawn])
+		| (Attack.knightAttack[square] & (pieces[WhiteKnight] | pieces[BlackKnight]))
+		| (Attack.kingAttack[square] & (pieces[WhiteKing] | pieces[BlackKing]))
+		| (bishopAttacks(square, occupied) & (pieces[WhiteBishop] | pieces[BlackBishop] | pieces[WhiteQueen] | pieces[BlackQueen]))
+		| (rookAttacks(square, occupied) & (pieces[WhiteRook] | pieces[BlackRook] | pieces[WhiteQueen] | pieces[BlackQueen]));
+}
+
+int ChessEngine::Board::psqtScore() const
+{
+	int score = 0;
+	for (int value : st->psqtValue)
+		score += value;
+	return score;
+}
+
+bool ChessEngine::Board::inCheck() const
+{
+	return checkers() != 0;
+}
+
+u64 ChessEngine::Board::checkers() const
+{
+	if (!st->kingInfoReady)
+		computeKingInfo();
+	return st->attacks.checkers;
+}
+
+u64 ChessEngine::Board::pinned(ui color) const
+{
+	if (!st->kingInfoReady)
+		computeKingInfo();
+	return st->attacks.pinned[color];
+}
+
+u64 ChessEngine::Board::pinners(ui color) const
+{
+	if (!st->kingInfoReady)
+		computeKingInfo();
+	return st->attacks.pinners[color];
+}
+
+u64 ChessEngine::Board::attackedBy(ui color, ui type) const
+{
+	if (!st->attacksReady)
+		computeAttacks();
+	return st->attacks.attackedBy[color][type];
+}
+
+// st là con trỏ nên hàm const vẫn ghi được bộ nhớ đệm của thế hiện tại
+void ChessEngine::Board::computeKingInfo() const
+{
+	AttackInfo& info = st->attacks;
+	u64 occupied = occupancy();
+	ui us = st->activeColor;
+
+	info.checkers = attackersTo(kingSquare(us), occupied) & colorPieces(us ^ 1);
+
+	for (ui color : { Black, White }) {
+		ui them = color ^ 1;
+		ui kingSq = kingSquare(color);
+		u64 theirQueen = pieces[makePiece(them, Queen)];
+		u64 snipers = (rookAttacks(kingSq, 0) & (pieces[makePiece(them, Rook)] | theirQueen))
+			| (bishopAttacks(kingSq, 0) & (pieces[makePiece(them, Bishop)] | theirQueen));
+		u64 ours = colorPieces(color);
+
+		info.pinned[color] = 0;
+		info.pinners[them] = 0;
+		while (snipers) {
+			ui sniperSq = popLsb(snipers);
+			u64 blockers = Attack.betweenSquares[kingSq][sniperSq] & occupied;
+			if (blockers && !(blockers & (blockers - 1)) && (blockers & ours)) {
+				info.pinned[color] |= blockers;
+				info.pinners[them] |= squareBB(sniperSq);
+			}
+		}
+	}
+	st->kingInfoReady = true;
+}
+
+void ChessEngine::Board::computeAttacks() const
+{
+	u64 occupied = occupancy();
+	for (ui color : { Black, White }) {
+		u64 (&by)[7] = st->attacks.attackedBy[color];
+		// Vua đối phương trong suốt: vua không thể lùi dọc đường bị chiếu
+		u64 occ = occupied ^ pieces[makePiece(color ^ 1, King)];
+
+		u64 pawns = pieces[makePiece(color, Pawn)];
+		by[Pawn] = color == White ? pawnAttacksBB<White>(pawns) : pawnAttacksBB<Black>(pawns);
+
+		by[Knight] = 0;
+		for (u64 bb = pieces[makePiece(color, Knight)]; bb; )
+			by[Knight] |= Attack.knightAttack[popLsb(bb)];
+		by[Bishop] = 0;
+		for (u64 bb = pieces[makePiece(color, Bishop)]; bb; )
+			by[Bishop] |= bishopAttacks(popLsb(bb), occ);
+		by[Rook] = 0;
+		for (u64 bb = pieces[makePiece(color, Rook)]; bb; )
+			by[Rook] |= rookAttacks(popLsb(bb), occ);
+		by[Queen] = 0;
+		for (u64 bb = pieces[makePiece(color, Queen)]; bb; )
+			by[Queen] |= queenAttacks(popLsb(bb), occ);
+		by[King] = Attack.kingAttack[kingSquare(color)];
+
+		by[AllPieces] = by[Pawn] | by[Knight] | by[Bishop] | by[Rook] | by[Queen] | by[King];
+	}
+	st->attacksReady = true;
+}
+
+bool ChessEngine::Board::hasNonPawnMaterial(ui color) const
+{
+	return colorPieces(color) & ~(pieces[makePiece(color, Pawn)] | pieces[makePiece(color, King)]);
+}
 
 void ChessEngine::Board::printBoard() const{
 	// Ký tự đại diện cho từng loại quân
@@ -153,6 +362,37 @@ void ChessEngine::Board::printBoard() const{
 	std::cout << "a b c d e f g h\n\n";
 }
 
+std::string ChessEngine::Board::toFen() const {
+	const char pieceChar[12] = { 'P', 'N', 'B', 'R', 'Q', 'K', 'p', 'n', 'b', 'r', 'q', 'k' };
+
+	std::string fen;
+	for (int rank = 7; rank >= 0; rank--) {
+		int empty = 0;
+		for (int file = 0; file < 8; file++) {
+			ui piece = piecesList[rank * 8 + file];
+			if (piece == NoPiece) {
+				empty++;
+				continue;
+			}
+			if (empty) fen += char('0' + empty);
+			empty = 0;
+			fen += pieceChar[piece];
+		}
+		if (empty) fen += char('0' + empty);
+		if (rank) fen += '/';
+	}
+
+	fen += st->activeColor == White ? " w " : " b ";
+	const char castlingChar[4] = { 'K', 'Q', 'k', 'q' };
+	for (int i = 0; i < 4; i++)
+		if (st->castling & (1 << i)) fen += castlingChar[i];
+	if (!(st->castling & 15)) fen += '-';
+	fen += ' ';
+	fen += st->enPassant < 64 ? squareToString(st->enPassant) : "-";
+	fen += ' ' + std::to_string(st->halfMove) + ' ' + std::to_string(st->fullMove);
+	return fen;
+}
+
 bool ChessEngine::Board::hasBishopPaired(const Color &side) const
 {
     ui bishopType = (side == White) ? WhiteBishop : BlackBishop;
@@ -185,21 +425,66 @@ bool ChessEngine::Board::fiftyMoveRule() const
 	return st->halfMove >= MAX_MOVE_RULE;
 }
 
-bool ChessEngine::Board::isDrawByRepetition() const {
-	int count = 0;
-	u64 key = st->zobristKey;
+bool ChessEngine::Board::isDrawByRepetition(int searchPly) const {
+	return st->repetition && st->repetition < searchPly;
+}
 
-	for (StateInfo* s = st; s != nullptr; s = s->previous) {
-		if (s->zobristKey == key) {
-			if (++count >= 3)
-				return true;
+// Chỉ xét các thế cùng bên đi (bước 2 ply); nước tốt/ăn quân (halfMove) hoặc
+// null move làm mọi thế trước đó không thể lặp lại
+void ChessEngine::Board::updateRepetition() {
+	st->repetition = 0;
+	int end = std::min<int>({ (int)st->halfMove, (int)st->pliesFromNull, (int)ply });
+	if (end < 4)
+		return;
+
+	const StateInfo* s = st->previous->previous;
+	for (int i = 4; i <= end; i += 2) {
+		s = s->previous->previous;
+		if (s->zobristKey == st->zobristKey) {
+			st->repetition = s->repetition ? -i : i;
+			return;
 		}
-
-		// Pawn move hoặc capture → không thể lặp trước đó
-		if (s->halfMove == 0)
-			break;
 	}
+}
+
+// Bước 2 ply như updateRepetition; với mỗi thế cũ cùng bên đi, hiệu zobrist
+// trùng một nước trong bảng cuckoo mà đường đi trống nghĩa là một nước đi đưa
+// về đúng thế đó (quân nằm ở from hay to đều được: quân đã đi thì đi ngược lại)
+bool ChessEngine::Board::hasUpcomingRepetition(int searchPly) const {
+	int end = std::min<int>({ (int)st->halfMove, (int)st->pliesFromNull, (int)ply });
+	if (end < 3)
+		return false;
+
+	u64 originalKey = st->zobristKey;
+	const StateInfo* s = st->previous;
+	// Tổng các nước của đối phương phải triệt tiêu: chỉ một nước của ta khác biệt
+	u64 other = originalKey ^ s->zobristKey ^ zobrist.sideToMove;
+
+	for (int i = 3; i <= end; i += 2) {
+		s = s->previous;
+		other ^= s->zobristKey ^ s->previous->zobristKey ^ zobrist.sideToMove;
+		s = s->previous;
+		if (other != 0)
+			continue;
+
+		u64 moveKey = originalKey ^ s->zobristKey;
+		ui j = Cuckoo::h1(moveKey);
+		if (cuckoo.keys[j] != moveKey) {
+			j = Cuckoo::h2(moveKey);
+			if (cuckoo.keys[j] != moveKey)
+				continue;
+		}
+
+		ui s1 = cuckoo.moves[j] & 63;
+		ui s2 = cuckoo.moves[j] >> 6;
+		if (Attack.betweenSquares[s1][s2] & occupancy())
+			continue;
 
+		// Trong cây tìm kiếm một lần lặp đã là hòa; trước gốc thế cũ phải
+		// tự nó đã lặp (để nước đi tạo ra lần thứ 3)
+		if (searchPly > i || s->repetition)
+			return true;
+	}
 	return false;
 }
 
@@ -246,24 +531,35 @@ bool ChessEngine::Board::isDrawByInsufficientMaterial() const
 
 
 
+template <Color Us>
 void ChessEngine::Board::doMove(const Move& move)
 {
+	constexpr ui OurPawn = makePiece(Us, Pawn);
+
 	StateInfo* newSt = &stateStack[++ply];
 
-	*newSt = *st;
+	// Chép mọi thứ trừ previous và bộ nhớ đệm tấn công
+	static_cast<StateCopy&>(*newSt) = *st;
+	newSt->kingInfoReady = newSt->attacksReady = false;
 	newSt->previous = st;
 	st = newSt;
 
-	ui from = move.from;
-	ui to = move.to;
+	ui from = move.from();
+	ui to = move.to();
 
-	st->moveFlags = move.flags;
 	st->promotedPiece = NoPiece;
 
 	ui movingPiece = piecesList[from];
 	ui capturedPiece = piecesList[to];
 	ui capturedSquare = to;
 
+	NNUE::DirtyPieces& dirty = st->dirty;
+	dirty.count = 1;
+	dirty.piece[0] = movingPiece;
+	dirty.from[0] = from;
+	dirty.to[0] = to;
+	if (accumulators) (*accumulators)[ply].computed = false;
+
 	st->capturedPiece = NoPiece;
 	st->capturedSquare = 64;
 
@@ -271,6 +567,9 @@ void ChessEngine::Board::doMove(const Move& move)
 	piecesList[from] = NoPiece;
 	resetBit(pieces[movingPiece], from);
 	st->zobristKey ^= zobrist.pieces[movingPiece][from];
+	st->psqtValue[movingPiece] -= psqt.value[movingPiece][from];
+	if (typeOf(movingPiece) == Pawn)
+		st->pawnKey ^= zobrist.pieces[movingPiece][from];
 
 	// ===== Remove old en-passant =====
 	if (st->previous->enPassant != 64)
@@ -280,9 +579,9 @@ void ChessEngine::Board::doMove(const Move& move)
 	st->zobristKey ^= zobrist.castlingRight[st->previous->castling];
 
 	// ===== Capture =====
-	if (move.flags & capture) {
-		if (move.flags & enPassant) {
-			capturedSquare = (st->activeColor == White) ? to - 8 : to + 8;
+	if (move.isCapture()) {
+		if (move.isEnPassant()) {
+			capturedSquare = to - pawnPush<Us>;
 			capturedPiece = piecesList[capturedSquare];
 		}
 
@@ -292,28 +591,35 @@ void ChessEngine::Board::doMove(const Move& move)
 		piecesList[capturedSquare] = NoPiece;
 		resetBit(pieces[capturedPiece], capturedSquare);
 		st->zobristKey ^= zobrist.pieces[capturedPiece][capturedSquare];
+		st->psqtValue[capturedPiece] -= psqt.value[capturedPiece][capturedSquare];
+		st->phaseValue -= piecePhase[capturedPiece];
+		if (typeOf(capturedPiece) == Pawn)
+			st->pawnKey ^= zobrist.pieces[capturedPiece][capturedSquare];
+
+		dirty.piece[dirty.count] = capturedPiece;
+		dirty.from[dirty.count] = capturedSquare;
+		dirty.to[dirty.count++] = NoSquare;
 	}
 
 	// ===== Promotion =====
-	if (move.flags & promotion) {
-		st->promotedPiece = promotePiece(movingPiece, move.promotion);
+	if (move.isPromotion()) {
+		st->promotedPiece = makePiece(Us, move.promotionType());
 		movingPiece = st->promotedPiece;
+		st->phaseValue += piecePhase[movingPiece];
+
+		// Tốt biến mất, quân phong cấp xuất hiện ở ô đích
+		dirty.to[0] = NoSquare;
+		dirty.piece[dirty.count] = movingPiece;
+		dirty.from[dirty.count] = NoSquare;
+		dirty.to[dirty.count++] = to;
 	}
 
 	// ===== Castling =====
-	if (move.flags & castling) {
-		ui rookFrom, rookTo;
-
-		if (to == g1 || to == g8) {
-			rookFrom = to + 1;
-			rookTo = to - 1;
-		}
-		else {
-			rookFrom = to - 2;
-			rookTo = to + 1;
-		}
-
-		ui rook = piecesList[rookFrom];
+	if (move.isCastling()) {
+		bool kingSide = to > from;
+		ui rookFrom = kingSide ? kingSideRookFrom<Us> : queenSideRookFrom<Us>;
+		ui rookTo = kingSide ? kingSideRookTo<Us> : queenSideRookTo<Us>;
+		constexpr ui rook = makePiece(Us, Rook);
 
 		piecesList[rookFrom] = NoPiece;
 		resetBit(pieces[rook], rookFrom);
@@ -322,12 +628,20 @@ void ChessEngine::Board::doMove(const Move& move)
 		piecesList[rookTo] = rook;
 		setBit(pieces[rook], rookTo);
 		st->zobristKey ^= zobrist.pieces[rook][rookTo];
+		st->psqtValue[rook] += psqt.value[rook][rookTo] - psqt.value[rook][rookFrom];
+
+		dirty.piece[dirty.count] = rook;
+		dirty.from[dirty.count] = rookFrom;
+		dirty.to[dirty.count++] = rookTo;
 	}
 
 	// ===== Place moving piece to TO =====
 	piecesList[to] = movingPiece;
 	setBit(pieces[movingPiece], to);
 	st->zobristKey ^= zobrist.pieces[movingPiece][to];
+	st->psqtValue[movingPiece] += psqt.value[movingPiece][to];
+	if (typeOf(movingPiece) == Pawn)
+		st->pawnKey ^= zobrist.pieces[movingPiece][to];
 
 	// ===== Update castling rights =====
 	st->castling &= castleMask[from];
@@ -336,13 +650,15 @@ void ChessEngine::Board::doMove(const Move& move)
 
 	// ===== En-passant =====
 	st->enPassant = NoSquare;
-	if (move.flags & doublePush) {
+	if (move.isDoublePush()) {
 		st->enPassant = (from + to) / 2;
 		st->zobristKey ^= zobrist.enPassant[st->enPassant % 8];
 	}
 
+	st->pliesFromNull++;
+
 	// ===== Halfmove clock =====
-	if (move.flags & capture || movingPiece == WhitePawn || movingPiece == BlackPawn)
+	if (move.isCapture() || move.isPromotion() || movingPiece == OurPawn)
 		st->halfMove = 0;
 	else
 		st->halfMove++;
@@ -352,33 +668,32 @@ void ChessEngine::Board::doMove(const Move& move)
 	st->zobristKey ^= zobrist.sideToMove;
 
 	// ===== Fullmove =====
-	if (st->activeColor == White)
+	if constexpr (Us == Black)
 		st->fullMove++;
+
+	updateRepetition();
 }
 
 
+template <Color Us>
 void ChessEngine::Board::undoMove(const Move& move)
 {
     StateInfo* cur = st;
     st = st->previous;
     ply--;
 
-    ui from = move.from;
-    ui to   = move.to;
+    ui from = move.from();
+    ui to   = move.to();
 
     ui movingPiece = piecesList[to];
 
-    // ===== Side to move =====
-    // (doMove đã flip, undo phải flip lại)
-    st->activeColor ^= 1;
-
     // ===== Remove moving piece from TO =====
     piecesList[to] = NoPiece;
     resetBit(pieces[movingPiece], to);
 
     // ===== Undo promotion =====
-    if (cur->moveFlags & promotion) {
-        movingPiece = unpromotePiece(movingPiece);
+    if (move.isPromotion()) {
+        movingPiece = makePiece(Us, Pawn);
     }
 
     // ===== Place piece back to FROM =====
@@ -386,18 +701,11 @@ void ChessEngine::Board::undoMove(const Move& move)
     setBit(pieces[movingPiece], from);
 
     // ===== Undo castling =====
-    if (cur->moveFlags & castling) {
-        ui rookFrom, rookTo;
-
-        if (to == g1 || to == g8) {
-            rookFrom = to + 1;
-            rookTo   = to - 1;
-        } else {
-            rookFrom = to - 2;
-            rookTo   = to + 1;
-        }
-
-        ui rook = piecesList[rookTo];
+    if (move.isCastling()) {
+        bool kingSide = to > from;
+        ui rookFrom = kingSide ? kingSideRookFrom<Us> : queenSideRookFrom<Us>;
+        ui rookTo   = kingSide ? kingSideRookTo<Us> : queenSideRookTo<Us>;
+        constexpr ui rook = makePiece(Us, Rook);
 
         piecesList[rookTo] = NoPiece;
         resetBit(pieces[rook], rookTo);
@@ -412,25 +720,50 @@ void ChessEngine::Board::undoMove(const Move& move)
         setBit(pieces[cur->capturedPiece], cur->capturedSquare);
     }
 
-    // Zobrist, castling, en-passant, clocks
+    // Zobrist, castling, en-passant, clocks, PSQT, phase
     // đã được restore hoàn toàn bằng StateInfo
 }
 
-ChessEngine::StateInfo::StateInfo()
-	: activeColor(1)     // Mặc định White = 1
-	, castling(0)        // Mặc định không có quyền nhập thành
-	, enPassant(NoSquare)      // 64 nghĩa là không có ô EP (NoSquare)
-	, halfMove(0)
-	, fullMove(1)
-	, zobristKey(0ULL)
-	, phaseValue(0)
-	, previous(nullptr)
-	, capturedPiece(NoPiece)
-	, capturedSquare(NoSquare)
-	, moveFlags(quiet)
-	, promotedPiece(promoNone)
+template void ChessEngine::Board::doMove<White>(const Move&);
+template void ChessEngine::Board::doMove<Black>(const Move&);
+template void ChessEngine::Board::undoMove<White>(const Move&);
+template void ChessEngine::Board::undoMove<Black>(const Move&);
+
+void ChessEngine::Board::doNullMove()
 {
-	// Khởi tạo mảng PSQT về 0
-	psqtValue.fill(0);
+	StateInfo* newSt = &stateStack[++ply];
+
+	static_cast<StateCopy&>(*newSt) = *st;
+	newSt->kingInfoReady = newSt->attacksReady = false;
+	newSt->previous = st;
+	st = newSt;
+
+	// Không quân nào đổi chỗ: accumulator chỉ cần chép lại từ ply trước
+	st->dirty.count = 0;
+	if (accumulators) (*accumulators)[ply].computed = false;
+
+	st->capturedPiece = NoPiece;
+	st->capturedSquare = NoSquare;
+	st->promotedPiece = NoPiece;
+
+	if (st->enPassant != NoSquare) {
+		st->zobristKey ^= zobrist.enPassant[st->enPassant % 8];
+		st->enPassant = NoSquare;
+	}
+
+	st->halfMove++;
+	st->pliesFromNull = 0;
+	st->repetition = 0;
+
+	st->activeColor ^= 1;
+	st->zobristKey ^= zobrist.sideToMove;
+
+	if (st->activeColor == White)
+		st->fullMove++;
 }
 
+void ChessEngine::Board::undoNullMove()
+{
+	st = st->previous;
+	ply--;
+}
@@ -1 +1,31 @@
-#include "Evaluator.h"
\ No newline at end of file
+#include "Evaluator.h"
+#include "PSQT.h"
+#include "NNUE.h"
+
+namespace ChessEngine
+{
+    int evaluate(const Board &board, PawnTable &pawns)
+    {
+        if (NNUE::isLoaded())
+            return NNUE::evaluate(board);
+
+        // Vật chất + PSQT đã được doMove cập nhật tăng dần: O(1) mỗi nút
+        int score = board.psqtScore();
+
+        // Cấu trúc tốt lấy từ PawnTable, gần như luôn trúng cache
+        PawnEntry *entry = pawns.probe(board);
+        score += entry->score;
+        score += entry->kingShelter(board, White, board.kingSquare(White));
+        score -= entry->kingShelter(board, Black, board.kingSquare(Black));
+
+        int phase = std::min<int>(board.st->phaseValue, MAX_PHASE);
+        int value = (mgValue(score) * phase + egValue(score) * (MAX_PHASE - phase)) / MAX_PHASE;
+        return board.st->activeColor == White ? value : -value;
+    }
+
+    int evaluate(const Board &board)
+    {
+        thread_local PawnTable pawns;
+        return evaluate(board, pawns);
+    }
+}
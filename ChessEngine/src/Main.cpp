@@ -1,16 +1,211 @@
-﻿#include "Board.h";
+﻿#include "Board.h"
+#include "Perft.h"
+#include "Search.h"
+#include "NNUE.h"
+#include "UCI.h"
+#include "SEE.h"
+#include "AttackTable.h"
+#include "Syzygy.h"
+#include "Book.h"
+#include "Batch.h"
+#include "TranspositionTable.h"
+#include <fstream>
 using namespace ChessEngine;
 
-int main() {
-	Fen newGame("r1bqk2r/ppp1bppp/2np1n2/1B2p3/3PP3/2N2N2/PPP2PPP/R1BQK2R w KQkq - 2 6");
-	std::unique_ptr<Board> board;
-	board = std::make_unique<Board>(newGame);
-	board->printBoard();
-	Move ma(e1, g1, castling);
-	board->doMove(ma);
-	board->printBoard();
-	board->undoMove(ma);
-	board->printBoard();
+namespace {
+	const char* startFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 
+	// Ghép các tham số còn lại thành một chuỗi FEN (FEN có khoảng trắng)
+	std::string fenFromArgs(int argc, char* argv[], int first) {
+		if (argc <= first) return startFen;
+		std::string fen = argv[first];
+		for (int i = first + 1; i < argc; i++) {
+			fen += ' ';
+			fen += argv[i];
+		}
+		return fen;
+	}
 
+	void printUsage() {
+		std::cout << "Usage:\n"
+			<< "  ChessEngine                      (UCI mode, reads commands from stdin)\n"
+			<< "  ChessEngine perft <depth> [fen]\n"
+			<< "  ChessEngine divide <depth> [fen]\n"
+			<< "  ChessEngine perftmt <depth> <threads> <hashMB> [fen]\n"
+			<< "  ChessEngine perftsuite [maxDepth] [threads] [hashMB]\n"
+			<< "  ChessEngine search <depth> <threads> [fen]\n"
+			<< "  ChessEngine bench [depth] [threads]\n"
+			<< "  ChessEngine smpbench [depth] [maxThreads]\n"
+			<< "  ChessEngine featurebench [depth]\n"
+			<< "  ChessEngine evalbench [netFile]\n"
+			<< "  ChessEngine ucitest\n"
+			<< "  ChessEngine seetest\n"
+			<< "  ChessEngine seebench\n"
+			<< "  ChessEngine sliderbench\n"
+			<< "  ChessEngine syzygy <path> <fen>\n"
+			<< "  ChessEngine syzygytest <path>\n"
+			<< "  ChessEngine booktest\n"
+			<< "  ChessEngine book <file.bin> [fen]\n"
+			<< "  ChessEngine batch [depth N] [nodes N] [threads N] [hash MB] [window N] [in file|-] [out file]\n";
+	}
+}
+
+int main(int argc, char* argv[]) {
+	// Không có tham số: GUI/match runner chạy engine ở chế độ UCI
+	if (argc < 2) {
+		UCI::loop();
+		return 0;
+	}
+
+	std::string command = argv[1];
+
+	if (command == "perftsuite") {
+		int maxDepth = argc > 2 ? std::stoi(argv[2]) : 5;
+		int threads = argc > 3 ? std::stoi(argv[3]) : 1;
+		size_t hashMB = argc > 4 ? std::stoul(argv[4]) : 0;
+		return runPerftSuite(maxDepth, threads, hashMB) ? 0 : 1;
+	}
+
+	if (command == "perftmt" && argc > 4) {
+		int depth = std::stoi(argv[2]);
+		int threads = std::stoi(argv[3]);
+		size_t hashMB = std::stoul(argv[4]);
+		Board board{ Fen(fenFromArgs(argc, argv, 5)) };
+		std::unique_ptr<PerftTable> table;
+		if (hashMB > 0)
+			table = std::make_unique<PerftTable>(hashMB);
+		printParallelPerft(parallelPerft(board, depth, threads, table.get()));
+		return 0;
+	}
+
+	if ((command == "perft" || command == "divide") && argc > 2) {
+		int depth = std::stoi(argv[2]);
+		Board board{ Fen(fenFromArgs(argc, argv, 3)) };
+		if (command == "divide") {
+			divide(board, depth);
+		}
+		else {
+			PerftResult result = runPerft(board, depth);
+			std::cout << "Nodes: " << result.nodes << "  Time: " << result.seconds
+				<< "s  NPS: " << result.nps() << "\n";
+		}
+		return 0;
+	}
+
+	if (command == "search" && argc > 3) {
+		Board board{ Fen(fenFromArgs(argc, argv, 4)) };
+		SearchPool pool;
+		pool.setThreads(std::stoi(argv[3]));
+		SearchLimits limits;
+		limits.depth = std::stoi(argv[2]);
+		SearchInfo info = pool.think(board, limits, [](const SearchInfo& info) { printSearchInfo(info); });
+		std::cout << "bestmove " << moveToString(info.bestMove) << "\n";
+		return 0;
+	}
+
+	if (command == "bench") {
+		runBench(argc > 2 ? std::stoi(argv[2]) : 6, argc > 3 ? std::stoi(argv[3]) : 1);
+		return 0;
+	}
+
+	if (command == "smpbench") {
+		runSmpBench(argc > 2 ? std::stoi(argv[2]) : 8, argc > 3 ? std::stoi(argv[3]) : 32);
+		return 0;
+	}
+
+	if (command == "featurebench") {
+		runFeatureBench(argc > 2 ? std::stoi(argv[2]) : 8);
+		return 0;
+	}
+
+	if (command == "evalbench") {
+		if (argc > 2 && !NNUE::load(argv[2])) {
+			std::cout << "Cannot load network " << argv[2] << "\n";
+			return 1;
+		}
+		NNUE::runEvalBench();
+		return 0;
+	}
+
+	if (command == "ucitest")
+		return UCI::runStopTest() ? 0 : 1;
+
+	if (command == "seetest")
+		return runSeeSuite() ? 0 : 1;
+
+	if (command == "seebench") {
+		runSeeBench();
+		return 0;
+	}
+
+	if (command == "sliderbench") {
+		runSliderBench();
+		return 0;
+	}
+
+	if (command == "syzygy" && argc > 3) {
+		return Syzygy::runProbe(argv[2], fenFromArgs(argc, argv, 3)) ? 0 : 1;
+	}
+
+	if (command == "syzygytest" && argc > 2) {
+		return Syzygy::runSuite(argv[2]) ? 0 : 1;
+	}
+
+	if (command == "booktest") {
+		return runBookKeySuite() ? 0 : 1;
+	}
+
+	if (command == "book" && argc > 2) {
+		return runBookProbe(argv[2], fenFromArgs(argc, argv, 3)) ? 0 : 1;
+	}
+
+	// Phân tích hàng loạt EPD/PGN: JSONL ra stdout (hoặc out), báo cáo ra stderr
+	if (command == "batch") {
+		BatchOptions options;
+		size_t hashMB = 64;
+		std::string inPath = "-", outPath;
+		for (int i = 2; i + 1 < argc; i += 2) {
+			std::string name = argv[i], value = argv[i + 1];
+			if (name == "depth") options.limits.depth = std::stoi(value);
+			else if (name == "nodes") options.limits.nodes = std::stoull(value);
+			else if (name == "threads") options.threads = std::stoi(value);
+			else if (name == "hash") hashMB = std::stoul(value);
+			else if (name == "window") options.window = std::stoul(value);
+			else if (name == "in") inPath = value;
+			else if (name == "out") outPath = value;
+			else {
+				printUsage();
+				return 1;
+			}
+		}
+		// Không có giới hạn nào thì mặc định depth 8
+		if (options.limits.depth == MAX_DEPTH && options.limits.nodes == 0)
+			options.limits.depth = 8;
+		TT.resize(hashMB);
+		TT.clear();
+
+		std::ifstream inFile;
+		if (inPath != "-") {
+			inFile.open(inPath);
+			if (!inFile) {
+				std::cerr << "Cannot open " << inPath << "\n";
+				return 1;
+			}
+		}
+		std::ofstream outFile;
+		if (!outPath.empty()) {
+			outFile.open(outPath);
+			if (!outFile) {
+				std::cerr << "Cannot open " << outPath << "\n";
+				return 1;
+			}
+		}
+		BatchReport report = runBatch(inPath != "-" ? static_cast<std::istream&>(inFile) : std::cin,
+			!outPath.empty() ? static_cast<std::ostream&>(outFile) : std::cout, options);
+		printBatchReport(report);
+		return 0;
+	}
+
+	printUsage();
+	return 1;
 }
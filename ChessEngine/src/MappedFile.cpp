@@ -0,0 +1,79 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ChessEngine
+{
+    bool MappedFile::open(const std::string &path, bool randomAccess)
+    {
+        close();
+#if defined(_WIN32)
+        HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            randomAccess ? FILE_FLAG_RANDOM_ACCESS : FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE)
+            return false;
+        DWORD sizeHigh;
+        DWORD sizeLow = GetFileSize(handle, &sizeHigh);
+        u64 size = u64(sizeHigh) << 32 | sizeLow;
+        // File rỗng không map được
+        HANDLE fileMapping = size ? CreateFileMapping(handle, nullptr, PAGE_READONLY, sizeHigh, sizeLow, nullptr) : nullptr;
+        CloseHandle(handle);
+        if (!fileMapping)
+            return false;
+        void *view = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+        if (!view)
+        {
+            CloseHandle(fileMapping);
+            return false;
+        }
+        mapping = fileMapping;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) || info.st_size <= 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        u64 size = u64(info.st_size);
+        void *view = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd); // mapping vẫn giữ file
+        if (view == MAP_FAILED)
+            return false;
+#if defined(MADV_RANDOM)
+        if (randomAccess)
+            madvise(view, size, MADV_RANDOM);
+#endif
+#endif
+        base = view;
+        length = size;
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (!base)
+            return;
+#if defined(_WIN32)
+        UnmapViewOfFile(base);
+        CloseHandle(mapping);
+        mapping = nullptr;
+#else
+        munmap(base, length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+}
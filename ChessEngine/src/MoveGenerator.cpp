@@ -0,0 +1,470 @@
+#include "MoveGenerator.h"
+#include "AttackTable.h"
+
+namespace ChessEngine
+{
+    namespace
+    {
+        // Thông tin về vua bên đi, lấy từ AttackInfo đã lưu trong StateInfo
+        struct KingInfo
+        {
+            ui kingSq;
+            u64 checkers; // Quân đối phương đang chiếu
+            u64 pinned;   // Quân ta bị ghim vào vua
+        };
+
+        // Quân ghim chỉ được đi trên đường thẳng nối nó với vua
+        inline bool pinAllows(const KingInfo &info, ui from, ui to)
+        {
+            return !(info.pinned & squareBB(from)) || (Attack.lineSquares[info.kingSq][from] & squareBB(to));
+        }
+
+        template <GenType Type>
+        void pushPromotions(MoveList &moveList, ui from, ui to, ui flags)
+        {
+            // Phong Hậu thuộc Captures, phong cấp dưới (không ăn quân) thuộc Quiets
+            bool isCapture = flags & capture;
+            if (Type != Quiets)
+                moveList.push(Move(from, to, flags | promotion, promoQueen));
+            if (Type != Captures || isCapture)
+            {
+                moveList.push(Move(from, to, flags | promotion, promoRook));
+                moveList.push(Move(from, to, flags | promotion, promoBishop));
+                moveList.push(Move(from, to, flags | promotion, promoKnight));
+            }
+        }
+
+        // Nước ăn của mọi tốt theo một hướng chéo, sinh bằng một phép dịch bitboard
+        template <GenType Type, Color Us, int Direction>
+        void pushPawnCaptures(MoveList &moveList, const KingInfo &info, u64 pawns, u64 targets)
+        {
+            u64 attacks = shiftBB<Direction>(pawns) & targets;
+            while (attacks)
+            {
+                ui to = popLsb(attacks);
+                ui from = to - Direction;
+                if (!pinAllows(info, from, to))
+                    continue;
+                if (squareBB(to) & promotionRank<Us>)
+                    pushPromotions<Type>(moveList, from, to, capture);
+                else
+                    moveList.push(Move(from, to, capture));
+            }
+        }
+
+        template <GenType Type, Color Us>
+        void generatePawnMoves(const Board &board, MoveList &moveList, const KingInfo &info,
+            u64 occupied, u64 enemies, u64 checkMask)
+        {
+            constexpr Color Them = Color(Us ^ 1);
+            constexpr int Up = pawnPush<Us>;
+            constexpr bool wantCaptures = Type != Quiets;
+            constexpr bool wantQuiets = Type != Captures;
+
+            u64 pawns = board.pieces[makePiece(Us, Pawn)];
+            u64 empty = ~occupied;
+
+            // ===== Pushes =====
+            u64 single = shiftBB<Up>(pawns) & empty;
+            u64 dbl = shiftBB<Up>(single & doublePushRank<Us>) & empty;
+            single &= checkMask;
+            dbl &= checkMask;
+
+            u64 promoPush = single & promotionRank<Us>;
+            while (promoPush)
+            {
+                ui to = popLsb(promoPush);
+                ui from = to - Up;
+                if (pinAllows(info, from, to))
+                    pushPromotions<Type>(moveList, from, to, quiet);
+            }
+
+            if constexpr (wantQuiets)
+            {
+                u64 quietPush = single & ~promotionRank<Us>;
+                while (quietPush)
+                {
+                    ui to = popLsb(quietPush);
+                    ui from = to - Up;
+                    if (pinAllows(info, from, to))
+                        moveList.push(Move(from, to, quiet));
+                }
+                while (dbl)
+                {
+                    ui to = popLsb(dbl);
+                    ui from = to - 2 * Up;
+                    if (pinAllows(info, from, to))
+                        moveList.push(Move(from, to, doublePush));
+                }
+            }
+
+            // ===== Captures =====
+            if constexpr (wantCaptures)
+            {
+                pushPawnCaptures<Type, Us, pawnCaptureWest<Us>>(moveList, info, pawns, enemies & checkMask);
+                pushPawnCaptures<Type, Us, pawnCaptureEast<Us>>(moveList, info, pawns, enemies & checkMask);
+
+                // ===== En passant =====
+                ui epSq = board.st->enPassant;
+                ui capSq = epSq - Up;
+                // Khi bị chiếu: phải ăn quân chiếu hoặc chặn đường chiếu
+                if (epSq < NoSquare && (checkMask & (squareBB(epSq) | squareBB(capSq))))
+                {
+                    u64 theirQueen = board.pieces[makePiece(Them, Queen)];
+                    u64 theirRooks = board.pieces[makePiece(Them, Rook)] | theirQueen;
+                    u64 theirBishops = board.pieces[makePiece(Them, Bishop)] | theirQueen;
+                    u64 epCapturers = Attack.pawnAttack[Them][epSq] & pawns;
+                    while (epCapturers)
+                    {
+                        ui from = popLsb(epCapturers);
+                        // Mô phỏng bàn cờ sau khi ăn để bắt cả trường hợp ghim ngang hai tốt
+                        u64 after = (occupied ^ squareBB(from) ^ squareBB(capSq)) | squareBB(epSq);
+                        if ((rookAttacks(info.kingSq, after) & theirRooks)
+                            || (bishopAttacks(info.kingSq, after) & theirBishops))
+                            continue;
+                        moveList.push(Move(from, epSq, capture | enPassant));
+                    }
+                }
+            }
+        }
+
+        template <GenType Type, Color Us, ui PieceTypeValue>
+        void generatePieceMoves(const Board &board, MoveList &moveList, const KingInfo &info,
+            u64 occupied, u64 enemies, u64 target)
+        {
+            u64 bb = board.pieces[makePiece(Us, PieceTypeValue)];
+            while (bb)
+            {
+                ui from = popLsb(bb);
+                u64 attacks;
+                if constexpr (PieceTypeValue == Knight)
+                    attacks = Attack.knightAttack[from];
+                else if constexpr (PieceTypeValue == Bishop)
+                    attacks = bishopAttacks(from, occupied);
+                else if constexpr (PieceTypeValue == Rook)
+                    attacks = rookAttacks(from, occupied);
+                else
+                    attacks = queenAttacks(from, occupied);
+
+                attacks &= target;
+                if (info.pinned & squareBB(from))
+                    attacks &= Attack.lineSquares[info.kingSq][from];
+
+                while (attacks)
+                {
+                    ui to = popLsb(attacks);
+                    moveList.push(Move(from, to, (squareBB(to) & enemies) ? capture : quiet));
+                }
+            }
+        }
+
+        template <GenType Type, Color Us>
+        void generateKingMoves(const Board &board, MoveList &moveList, const KingInfo &info,
+            u64 occupied, u64 enemies, u64 stageMask)
+        {
+            constexpr Color Them = Color(Us ^ 1);
+            ui from = info.kingSq;
+            // attackedBy coi vua ta trong suốt nên ô phía sau vua trên đường chiếu cũng bị loại
+            u64 attacked = board.attackedBy(Them);
+            u64 attacks = Attack.kingAttack[from] & ~board.colorPieces(Us) & ~attacked & stageMask;
+            while (attacks)
+            {
+                ui to = popLsb(attacks);
+                moveList.push(Move(from, to, (squareBB(to) & enemies) ? capture : quiet));
+            }
+
+            // ===== Castling =====
+            if constexpr (Type == Quiets || Type == Legal)
+            {
+                if (info.checkers)
+                    return;
+                ui rights = board.st->castling;
+                constexpr ui rook = makePiece(Us, Rook);
+
+                if ((rights & kingSideRight<Us>) && board.piecesList[kingSideRookFrom<Us>] == rook
+                    && !(Attack.betweenSquares[from][kingSideRookFrom<Us>] & occupied)
+                    && !(attacked & (squareBB(from + 1) | squareBB(from + 2))))
+                    moveList.push(Move(from, from + 2, castling));
+
+                if ((rights & queenSideRight<Us>) && board.piecesList[queenSideRookFrom<Us>] == rook
+                    && !(Attack.betweenSquares[from][queenSideRookFrom<Us>] & occupied)
+                    && !(attacked & (squareBB(from - 1) | squareBB(from - 2))))
+                    moveList.push(Move(from, from - 2, castling));
+            }
+        }
+
+        template <GenType Type, Color Us>
+        void generateAll(const Board &board, MoveList &moveList)
+        {
+            u64 occupied = board.occupancy();
+            u64 enemies = board.colorPieces(Us ^ 1);
+            KingInfo info{ board.kingSquare(Us), board.checkers(), board.pinned(Us) };
+
+            // Ô đích cho phép theo giai đoạn sinh nước
+            u64 stageMask;
+            if constexpr (Type == Captures)
+                stageMask = enemies;
+            else if constexpr (Type == Quiets)
+                stageMask = ~occupied;
+            else
+                stageMask = ~board.colorPieces(Us);
+
+            if constexpr (Type == Evasions)
+            {
+                if (!info.checkers)
+                    return;
+            }
+
+            generateKingMoves<Type, Us>(board, moveList, info, occupied, enemies, stageMask);
+
+            // Chiếu đôi: chỉ vua được đi
+            if (info.checkers & (info.checkers - 1))
+                return;
+
+            // Khi bị chiếu: chỉ được ăn quân chiếu hoặc chặn giữa
+            u64 checkMask = Universe;
+            if (info.checkers)
+                checkMask = Attack.betweenSquares[info.kingSq][lsb(info.checkers)] | info.checkers;
+            u64 target = stageMask & checkMask;
+
+            generatePawnMoves<Type, Us>(board, moveList, info, occupied, enemies, checkMask);
+            generatePieceMoves<Type, Us, Knight>(board, moveList, info, occupied, enemies, target);
+            generatePieceMoves<Type, Us, Bishop>(board, moveList, info, occupied, enemies, target);
+            generatePieceMoves<Type, Us, Rook>(board, moveList, info, occupied, enemies, target);
+            generatePieceMoves<Type, Us, Queen>(board, moveList, info, occupied, enemies, target);
+        }
+    }
+
+    // Rẽ nhánh theo bên đi một lần, phần còn lại là mã riêng cho từng màu
+    template <GenType Type>
+    void generate(const Board &board, MoveList &moveList)
+    {
+        if (board.st->activeColor == White)
+            generateAll<Type, White>(board, moveList);
+        else
+            generateAll<Type, Black>(board, moveList);
+    }
+
+    template void generate<Captures>(const Board &, MoveList &);
+    template void generate<Quiets>(const Board &, MoveList &);
+    template void generate<Evasions>(const Board &, MoveList &);
+    template void generate<Legal>(const Board &, MoveList &);
+
+    void generateCaptures(const Board &board, MoveList &moveList)
+    {
+        generate<Captures>(board, moveList);
+    }
+
+    void generateQuiets(const Board &board, MoveList &moveList)
+    {
+        generate<Quiets>(board, moveList);
+    }
+
+    void generateEvasions(const Board &board, MoveList &moveList)
+    {
+        generate<Evasions>(board, moveList);
+    }
+
+    void generateLegalMoves(const Board &board, MoveList &moveList)
+    {
+        generate<Legal>(board, moveList);
+    }
+
+    Move parseMove(const Board &board, const std::string &text)
+    {
+        MoveList moveList;
+        generateLegalMoves(board, moveList);
+        for (const Move &move : moveList)
+            if (moveToString(move) == text)
+                return move;
+        return Move();
+    }
+
+    Move parseSan(const Board &board, const std::string &text)
+    {
+        std::string san = text;
+        while (!san.empty() && std::string("+#!?").find(san.back()) != std::string::npos)
+            san.pop_back();
+
+        MoveList moveList;
+        generateLegalMoves(board, moveList);
+
+        // Nhập thành: cánh vua thì vua đi sang phải (file tăng)
+        if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0")
+        {
+            bool kingSide = san.size() == 3;
+            for (const Move &move : moveList)
+                if (move.isCastling() && ((move.to() % 8 > move.from() % 8) == kingSide))
+                    return move;
+            return Move();
+        }
+
+        ui type = Pawn;
+        size_t pos = 0;
+        const std::string pieceLetters = "PNBRQK";
+        if (!san.empty() && pieceLetters.find(san[0]) != std::string::npos)
+            type = ui(pieceLetters.find(san[pos++]));
+
+        // Quân phong cấp ở cuối ("e8=Q" hoặc "e8Q")
+        ui promo = promoNone;
+        if (type == Pawn && san.size() > pos && std::string("NBRQ").find(san.back()) != std::string::npos)
+        {
+            promo = ui(std::string("NBRQ").find(san.back())) + promoKnight;
+            san.pop_back();
+            if (!san.empty() && san.back() == '=')
+                san.pop_back();
+        }
+
+        // Phần còn lại: [file][rank][x|-]ô_đích
+        std::string body;
+        for (size_t i = pos; i < san.size(); i++)
+            if (san[i] != 'x' && san[i] != '-' && san[i] != ':')
+                body += san[i];
+        if (body.size() < 2 || body.size() > 4)
+            return Move();
+        char toFile = body[body.size() - 2], toRank = body[body.size() - 1];
+        if (toFile < 'a' || toFile > 'h' || toRank < '1' || toRank > '8')
+            return Move();
+        ui to = ui(toRank - '1') * 8 + ui(toFile - 'a');
+
+        int fromFile = -1, fromRank = -1;
+        for (size_t i = 0; i + 2 < body.size(); i++)
+        {
+            if (body[i] >= 'a' && body[i] <= 'h')
+                fromFile = body[i] - 'a';
+            else if (body[i] >= '1' && body[i] <= '8')
+                fromRank = body[i] - '1';
+            else
+                return Move();
+        }
+
+        Move found;
+        for (const Move &move : moveList)
+        {
+            if (move.to() != to || typeOf(board.piecesList[move.from()]) != type || move.isCastling())
+                continue;
+            if ((move.isPromotion() ? move.promotionType() : ui(promoNone)) != promo)
+                continue;
+            if ((fromFile >= 0 && int(move.from() % 8) != fromFile) || (fromRank >= 0 && int(move.from() / 8) != fromRank))
+                continue;
+            if (!found.isNone())
+                return Move(); // mơ hồ
+            found = move;
+        }
+        return found;
+    }
+
+    bool isLegal(const Board &board, Move move)
+    {
+        // Mã 3, 6, 7 không được dùng (xem MoveFlag)
+        ui code = move.flags();
+        if (move.isNone() || code == 3 || code == 6 || code == 7)
+            return false;
+
+        ui us = board.st->activeColor;
+        ui them = us ^ 1;
+        ui from = move.from();
+        ui to = move.to();
+        ui piece = board.piecesList[from];
+        if (piece == NoPiece || piece != makePiece(us, typeOf(piece)))
+            return false;
+
+        u64 ours = board.colorPieces(us);
+        u64 theirs = board.colorPieces(them);
+        u64 occupied = ours | theirs;
+        if (ours & squareBB(to))
+            return false;
+
+        ui type = typeOf(piece);
+        ui target = board.piecesList[to];
+        if (target != NoPiece && typeOf(target) == King)
+            return false;
+
+        u64 checkers = board.checkers();
+
+        // ===== Castling: kiểm tra đầy đủ như lúc sinh nước =====
+        if (move.isCastling())
+        {
+            ui kingStart = (us == White) ? e1 : e8;
+            if (type != King || from != kingStart || checkers)
+                return false;
+            bool kingSide = to == from + 2;
+            if (!kingSide && to + 2 != from)
+                return false;
+            ui right = (us == White) ? (kingSide ? 1 : 2) : (kingSide ? 4 : 8);
+            ui rookSq = kingSide ? from + 3 : from - 4;
+            ui step1 = kingSide ? from + 1 : from - 1;
+            return (board.st->castling & right)
+                && board.piecesList[rookSq] == makePiece(us, Rook)
+                && !(Attack.betweenSquares[from][rookSq] & occupied)
+                && !(board.attackedBy(them) & (squareBB(step1) | squareBB(to)));
+        }
+
+        // ===== Hình học nước đi (pseudo-legal) =====
+        int up = (us == White) ? N : S;
+        ui capSq = to;
+        if (move.isEnPassant())
+        {
+            if (type != Pawn || to != board.st->enPassant || !(Attack.pawnAttack[us][from] & squareBB(to)))
+                return false;
+            capSq = to - up;
+        }
+        else if (move.isCapture() != (target != NoPiece))
+            return false;
+
+        if (type == Pawn)
+        {
+            bool lastRank = squareBB(to) & ((us == White) ? Rank8 : Rank1);
+            if (move.isPromotion() != lastRank)
+                return false;
+            if (move.isCapture())
+            {
+                if (!(Attack.pawnAttack[us][from] & squareBB(to)))
+                    return false;
+            }
+            else if (move.isDoublePush())
+            {
+                ui startRank = (us == White) ? 1 : 6;
+                if (from / 8 != startRank || to != from + 2 * up
+                    || (occupied & (squareBB(from + up) | squareBB(to))))
+                    return false;
+            }
+            else if (to != from + up || (occupied & squareBB(to)))
+                return false;
+        }
+        else
+        {
+            if (move.isPromotion() || move.isDoublePush())
+                return false;
+            u64 attacks = type == Knight ? Attack.knightAttack[from]
+                : type == Bishop ? bishopAttacks(from, occupied)
+                : type == Rook ? rookAttacks(from, occupied)
+                : type == Queen ? queenAttacks(from, occupied)
+                : Attack.kingAttack[from];
+            if (!(attacks & squareBB(to)))
+                return false;
+        }
+
+        // ===== Vua không bị chiếu sau nước đi =====
+        if (type == King)
+            return !(board.attackedBy(them) & squareBB(to));
+
+        // Ăn qua đường có thể mở đường ngang cho hai tốt cùng lúc: mô phỏng đầy đủ
+        ui kingSq = board.kingSquare(us);
+        if (move.isEnPassant())
+        {
+            u64 after = (occupied ^ squareBB(from) ^ squareBB(capSq)) | squareBB(to);
+            return !(board.attackersTo(kingSq, after) & theirs & ~squareBB(capSq));
+        }
+
+        // Chiếu đôi chỉ vua thoát được; chiếu đơn phải ăn quân chiếu hoặc chặn
+        if (checkers)
+        {
+            if (checkers & (checkers - 1))
+                return false;
+            if (!((Attack.betweenSquares[kingSq][lsb(checkers)] | checkers) & squareBB(to)))
+                return false;
+        }
+        return !(board.pinned(us) & squareBB(from)) || (Attack.lineSquares[kingSq][from] & squareBB(to));
+    }
+}
@@ -0,0 +1,196 @@
+#include "MovePicker.h"
+#include "MoveGenerator.h"
+#include "Evaluator.h"
+#include "SEE.h"
+
+namespace ChessEngine
+{
+    namespace
+    {
+        // Nạn nhân có giá trị cao trước, cùng nạn nhân thì quân ăn rẻ trước
+        int mvvLva(const Board &board, Move move)
+        {
+            return captureGain(board, move) * 8 - (int)typeOf(board.piecesList[move.from()]);
+        }
+    }
+
+    MovePicker::MovePicker(const Board &b, Move tt, const Move *killers, Move counterMove,
+        const ButterflyHistory *h, const PieceToHistory *const *cont)
+        : board(b), history(h), continuation(cont)
+    {
+        ttMove = isLegal(board, tt) ? tt : Move();
+        refutations[0] = killers[0];
+        refutations[1] = killers[1];
+        refutations[2] = counterMove;
+
+        stage = board.inCheck() ? EvasionTT : MainTT;
+        if (ttMove.isNone())
+            stage = Stage(stage + 1);
+    }
+
+    MovePicker::MovePicker(const Board &b, Move tt, const ButterflyHistory *h, const PieceToHistory *const *cont)
+        : board(b), history(h), continuation(cont)
+    {
+        bool inCheck = board.inCheck();
+        ttMove = isLegal(board, tt) && (inCheck || isTactical(tt)) ? tt : Move();
+
+        stage = inCheck ? EvasionTT : QSearchTT;
+        if (ttMove.isNone())
+            stage = Stage(stage + 1);
+    }
+
+    void MovePicker::scoreCaptures(int begin, int end)
+    {
+        for (int i = begin; i < end; i++)
+            moves[i].score = int16_t(mvvLva(board, moves[i]));
+    }
+
+    void MovePicker::scoreQuiets(int begin, int end)
+    {
+        ui us = board.st->activeColor;
+        for (int i = begin; i < end; i++)
+        {
+            ExtMove &move = moves[i];
+            ui piece = board.piecesList[move.from()];
+            int score = history->table[us][move.from()][move.to()];
+            for (int k = 0; k < 2; k++)
+                if (continuation[k])
+                    score += continuation[k]->table[piece][move.to()];
+            move.score = int16_t(std::clamp(score, -32000, 32000));
+        }
+    }
+
+    ExtMove &MovePicker::pickBest(int index, int end)
+    {
+        int best = index;
+        for (int i = index + 1; i < end; i++)
+            if (moves[i].score > moves[best].score)
+                best = i;
+        std::swap(moves[index], moves[best]);
+        return moves[index];
+    }
+
+    bool MovePicker::isRefutation(Move move) const
+    {
+        return move == refutations[0] || move == refutations[1] || move == refutations[2];
+    }
+
+    Move MovePicker::next()
+    {
+        switch (stage)
+        {
+        case MainTT:
+        case EvasionTT:
+        case QSearchTT:
+            stage = Stage(stage + 1);
+            return ttMove;
+
+        case CaptureInit:
+            generateCaptures(board, moves);
+            endCaptures = moves.count();
+            scoreCaptures(0, endCaptures);
+            stage = GoodCaptures;
+            [[fallthrough]];
+
+        case GoodCaptures:
+            while (current < endCaptures)
+            {
+                ExtMove &move = pickBest(current++, endCaptures);
+                if (move == ttMove)
+                    continue;
+
+                // Trao đổi thua vật chất (SEE < 0): để lại cuối
+                if (!seeGe(board, move, 0))
+                {
+                    moves[endBadCaptures++] = move;
+                    continue;
+                }
+                return move;
+            }
+            stage = Refutations;
+            [[fallthrough]];
+
+        case Refutations:
+            while (refutationIndex < 3)
+            {
+                Move move = refutations[refutationIndex++];
+                if (move.isNone() || move == ttMove || isTactical(move))
+                    continue;
+                // Counter-move trùng killer đã trả về
+                if (refutationIndex == 3 && (move == refutations[0] || move == refutations[1]))
+                    continue;
+                if (refutationIndex == 2 && move == refutations[0])
+                    continue;
+                if (isLegal(board, move))
+                    return move;
+            }
+            stage = QuietInit;
+            [[fallthrough]];
+
+        case QuietInit:
+            generateQuiets(board, moves);
+            scoreQuiets(endCaptures, moves.count());
+            current = endCaptures;
+            stage = Quiets;
+            [[fallthrough]];
+
+        case Quiets:
+            while (current < moves.count())
+            {
+                ExtMove &move = pickBest(current++, moves.count());
+                if (move == ttMove || isRefutation(move))
+                    continue;
+                return move;
+            }
+            current = 0;
+            stage = BadCaptures;
+            [[fallthrough]];
+
+        case BadCaptures:
+            if (current < endBadCaptures)
+                return moves[current++];
+            stage = Done;
+            return Move();
+
+        case EvasionInit:
+            // Thoát chiếu bằng ăn quân (điểm MVV-LVA dương) luôn xếp trước các
+            // nước đi vua/chặn, vốn được dời xuống nửa âm của int16
+            generateEvasions(board, moves);
+            scoreQuiets(0, moves.count());
+            for (ExtMove &move : moves)
+                move.score = move.isCapture() ? int16_t(mvvLva(board, move)) : int16_t(move.score / 2 - HISTORY_MAX);
+            stage = Evasions;
+            [[fallthrough]];
+
+        case Evasions:
+            while (current < moves.count())
+            {
+                ExtMove &move = pickBest(current++, moves.count());
+                if (!(move == ttMove))
+                    return move;
+            }
+            stage = Done;
+            return Move();
+
+        case QCaptureInit:
+            generateCaptures(board, moves);
+            scoreCaptures(0, moves.count());
+            stage = QCaptures;
+            [[fallthrough]];
+
+        case QCaptures:
+            while (current < moves.count())
+            {
+                ExtMove &move = pickBest(current++, moves.count());
+                if (!(move == ttMove))
+                    return move;
+            }
+            stage = Done;
+            return Move();
+
+        case Done:
+            return Move();
+        }
+        return Move();
+    }
+}
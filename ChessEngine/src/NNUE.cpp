@@ -0,0 +1,405 @@
+#include "NNUE.h"
+#include "Board.h"
+#include "MoveGenerator.h"
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NNUE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define NNUE_TARGET(isa)
+#else
+#define NNUE_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace ChessEngine::NNUE
+{
+    namespace
+    {
+        struct Network {
+            alignas(64) int16_t featureWeights[INPUTS][HIDDEN];
+            alignas(64) int16_t featureBias[HIDDEN];
+            alignas(64) int16_t outputWeights[2 * HIDDEN];
+            int32_t outputBias;
+        };
+
+        std::unique_ptr<Network> network;
+
+        // ===== Kernels =====
+        // addSub: dst = src + sum(add[i]) - sum(sub[i]) trên HIDDEN phần tử
+        // forward: sum(clamp(us, 0, QA) * w[0..H)) + sum(clamp(them, 0, QA) * w[H..2H))
+        using AddSubFn = void (*)(int16_t *dst, const int16_t *src,
+            const int16_t *const *add, int addCount, const int16_t *const *sub, int subCount);
+        using ForwardFn = int (*)(const int16_t *us, const int16_t *them, const int16_t *weights);
+
+        void addSubScalar(int16_t *dst, const int16_t *src,
+            const int16_t *const *add, int addCount, const int16_t *const *sub, int subCount)
+        {
+            for (int i = 0; i < HIDDEN; i++)
+            {
+                int16_t value = src[i];
+                for (int k = 0; k < addCount; k++)
+                    value += add[k][i];
+                for (int k = 0; k < subCount; k++)
+                    value -= sub[k][i];
+                dst[i] = value;
+            }
+        }
+
+        int forwardScalar(const int16_t *us, const int16_t *them, const int16_t *weights)
+        {
+            int sum = 0;
+            for (int i = 0; i < HIDDEN; i++)
+            {
+                sum += std::clamp<int>(us[i], 0, QA) * weights[i];
+                sum += std::clamp<int>(them[i], 0, QA) * weights[HIDDEN + i];
+            }
+            return sum;
+        }
+
+#ifdef NNUE_X86
+        NNUE_TARGET("sse4.1")
+        void addSubSSE41(int16_t *dst, const int16_t *src,
+            const int16_t *const *add, int addCount, const int16_t *const *sub, int subCount)
+        {
+            for (int i = 0; i < HIDDEN; i += 8)
+            {
+                __m128i value = _mm_load_si128((const __m128i *)(src + i));
+                for (int k = 0; k < addCount; k++)
+                    value = _mm_add_epi16(value, _mm_load_si128((const __m128i *)(add[k] + i)));
+                for (int k = 0; k < subCount; k++)
+                    value = _mm_sub_epi16(value, _mm_load_si128((const __m128i *)(sub[k] + i)));
+                _mm_store_si128((__m128i *)(dst + i), value);
+            }
+        }
+
+        NNUE_TARGET("sse4.1")
+        int forwardSSE41(const int16_t *us, const int16_t *them, const int16_t *weights)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i qa = _mm_set1_epi16(QA);
+            __m128i sum = _mm_setzero_si128();
+            for (int i = 0; i < HIDDEN; i += 8)
+            {
+                __m128i a = _mm_min_epi16(_mm_max_epi16(_mm_load_si128((const __m128i *)(us + i)), zero), qa);
+                __m128i b = _mm_min_epi16(_mm_max_epi16(_mm_load_si128((const __m128i *)(them + i)), zero), qa);
+                sum = _mm_add_epi32(sum, _mm_madd_epi16(a, _mm_load_si128((const __m128i *)(weights + i))));
+                sum = _mm_add_epi32(sum, _mm_madd_epi16(b, _mm_load_si128((const __m128i *)(weights + HIDDEN + i))));
+            }
+            sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+            sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+            return _mm_cvtsi128_si32(sum);
+        }
+
+        NNUE_TARGET("avx2")
+        void addSubAVX2(int16_t *dst, const int16_t *src,
+            const int16_t *const *add, int addCount, const int16_t *const *sub, int subCount)
+        {
+            for (int i = 0; i < HIDDEN; i += 16)
+            {
+                __m256i value = _mm256_load_si256((const __m256i *)(src + i));
+                for (int k = 0; k < addCount; k++)
+                    value = _mm256_add_epi16(value, _mm256_load_si256((const __m256i *)(add[k] + i)));
+                for (int k = 0; k < subCount; k++)
+                    value = _mm256_sub_epi16(value, _mm256_load_si256((const __m256i *)(sub[k] + i)));
+                _mm256_store_si256((__m256i *)(dst + i), value);
+            }
+        }
+
+        NNUE_TARGET("avx2")
+        int forwardAVX2(const int16_t *us, const int16_t *them, const int16_t *weights)
+        {
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i qa = _mm256_set1_epi16(QA);
+            __m256i sum = _mm256_setzero_si256();
+            for (int i = 0; i < HIDDEN; i += 16)
+            {
+                __m256i a = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256((const __m256i *)(us + i)), zero), qa);
+                __m256i b = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256((const __m256i *)(them + i)), zero), qa);
+                sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, _mm256_load_si256((const __m256i *)(weights + i))));
+                sum = _mm256_add_epi32(sum, _mm256_madd_epi16(b, _mm256_load_si256((const __m256i *)(weights + HIDDEN + i))));
+            }
+            __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+            half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+            half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+            return _mm_cvtsi128_si32(half);
+        }
+
+        bool cpuSupports(Backend backend)
+        {
+            if (backend == Backend::Scalar)
+                return true;
+#if defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 1);
+            bool sse41 = info[2] & (1 << 19);
+            bool osAvx = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6; // OSXSAVE + YMM state
+            __cpuidex(info, 7, 0);
+            bool avx2 = osAvx && (info[1] & (1 << 5));
+            return backend == Backend::AVX2 ? avx2 : sse41;
+#else
+            __builtin_cpu_init();
+            return backend == Backend::AVX2 ? __builtin_cpu_supports("avx2") : __builtin_cpu_supports("sse4.1");
+#endif
+        }
+#else
+        bool cpuSupports(Backend backend)
+        {
+            return backend == Backend::Scalar;
+        }
+#endif
+
+        Backend backend = Backend::Scalar;
+        AddSubFn addSub = addSubScalar;
+        ForwardFn forward = forwardScalar;
+
+        // Chỉ số feature của quân piece ở ô sq theo góc nhìn perspective:
+        // quân "của mình" ở nửa đầu, bàn cờ lật dọc với góc nhìn bên Đen
+        inline int featureIndex(ui perspective, ui piece, ui sq)
+        {
+            ui color = piece <= WhiteKing ? White : Black;
+            int side = color == perspective ? 0 : 384;
+            ui relativeSq = perspective == White ? sq : sq ^ 56;
+            return side + int(typeOf(piece)) * 64 + int(relativeSq);
+        }
+
+        void refresh(const Board &board, Accumulator &acc)
+        {
+            const int16_t *features[32]; // thế cờ hợp lệ có tối đa 32 quân
+            for (ui perspective : { Black, White })
+            {
+                int count = 0;
+                u64 occupied = board.occupancy();
+                while (occupied && count < 32)
+                {
+                    ui sq = popLsb(occupied);
+                    features[count++] = network->featureWeights[featureIndex(perspective, board.piecesList[sq], sq)];
+                }
+                addSub(acc.values[perspective], network->featureBias, features, count, nullptr, 0);
+            }
+            acc.computed = true;
+        }
+
+        void applyDirty(const NNUE::DirtyPieces &dirty, const Accumulator &parent, Accumulator &acc)
+        {
+            const int16_t *adds[3];
+            const int16_t *subs[3];
+            for (ui perspective : { Black, White })
+            {
+                int addCount = 0, subCount = 0;
+                for (int i = 0; i < dirty.count; i++)
+                {
+                    if (dirty.from[i] != NoSquare)
+                        subs[subCount++] = network->featureWeights[featureIndex(perspective, dirty.piece[i], dirty.from[i])];
+                    if (dirty.to[i] != NoSquare)
+                        adds[addCount++] = network->featureWeights[featureIndex(perspective, dirty.piece[i], dirty.to[i])];
+                }
+                addSub(acc.values[perspective], parent.values[perspective], adds, addCount, subs, subCount);
+            }
+            acc.computed = true;
+        }
+
+        // Đưa accumulator của ply hiện tại về trạng thái đúng: cập nhật tăng
+        // dần từ ply tổ tiên gần nhất đã tính, không có thì tính lại từ đầu
+        const Accumulator &ensureAccumulator(const Board &board)
+        {
+            if (!board.accumulators)
+                board.accumulators = std::make_unique<Board::AccumulatorStack>();
+            Board::AccumulatorStack &stack = *board.accumulators;
+
+            int target = int(board.ply);
+            int start = target;
+            while (start > 0 && !stack[start].computed)
+                start--;
+
+            if (!stack[start].computed)
+            {
+                refresh(board, stack[target]);
+                return stack[target];
+            }
+
+            for (int ply = start + 1; ply <= target; ply++)
+                applyDirty(board.stateStack[ply].dirty, stack[ply - 1], stack[ply]);
+            return stack[target];
+        }
+    }
+
+    Backend detectBackend()
+    {
+        if (cpuSupports(Backend::AVX2))
+            return Backend::AVX2;
+        if (cpuSupports(Backend::SSE41))
+            return Backend::SSE41;
+        return Backend::Scalar;
+    }
+
+    void setBackend(Backend requested)
+    {
+        if (!cpuSupports(requested))
+            requested = Backend::Scalar;
+        backend = requested;
+        addSub = addSubScalar;
+        forward = forwardScalar;
+#ifdef NNUE_X86
+        if (backend == Backend::SSE41)
+        {
+            addSub = addSubSSE41;
+            forward = forwardSSE41;
+        }
+        else if (backend == Backend::AVX2)
+        {
+            addSub = addSubAVX2;
+            forward = forwardAVX2;
+        }
+#endif
+    }
+
+    Backend currentBackend()
+    {
+        return backend;
+    }
+
+    const char *backendName(Backend b)
+    {
+        switch (b)
+        {
+        case Backend::AVX2: return "avx2";
+        case Backend::SSE41: return "sse4.1";
+        default: return "scalar";
+        }
+    }
+
+    bool load(const std::string &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+
+        char magic[4];
+        uint32_t version = 0, hidden = 0;
+        file.read(magic, 4);
+        file.read(reinterpret_cast<char *>(&version), sizeof(version));
+        file.read(reinterpret_cast<char *>(&hidden), sizeof(hidden));
+        if (!file || std::string(magic, 4) != "CENN" || version != 1 || hidden != HIDDEN)
+            return false;
+
+        auto net = std::make_unique<Network>();
+        file.read(reinterpret_cast<char *>(net->featureWeights), sizeof(net->featureWeights));
+        file.read(reinterpret_cast<char *>(net->featureBias), sizeof(net->featureBias));
+        file.read(reinterpret_cast<char *>(net->outputWeights), sizeof(net->outputWeights));
+        file.read(reinterpret_cast<char *>(&net->outputBias), sizeof(net->outputBias));
+        if (!file)
+            return false;
+
+        network = std::move(net);
+        setBackend(detectBackend());
+        return true;
+    }
+
+    void initRandom(u64 seed)
+    {
+        std::mt19937_64 rng(seed);
+        std::uniform_int_distribution<int> small(-64, 64);
+
+        auto net = std::make_unique<Network>();
+        for (auto &row : net->featureWeights)
+            for (int16_t &w : row)
+                w = int16_t(small(rng));
+        for (int16_t &b : net->featureBias)
+            b = int16_t(small(rng));
+        for (int16_t &w : net->outputWeights)
+            w = int16_t(small(rng));
+        net->outputBias = 0;
+
+        network = std::move(net);
+        setBackend(detectBackend());
+    }
+
+    bool isLoaded()
+    {
+        return network != nullptr;
+    }
+
+    void unload()
+    {
+        network.reset();
+    }
+
+    int evaluate(const Board &board)
+    {
+        const Accumulator &acc = ensureAccumulator(board);
+        ui us = board.st->activeColor;
+        int sum = forward(acc.values[us], acc.values[us ^ 1], network->outputWeights);
+        return int((long long)(sum + network->outputBias) * SCALE / (QA * QB));
+    }
+
+    void runEvalBench(std::ostream &out)
+    {
+        bool hadNetwork = isLoaded();
+        if (!hadNetwork)
+        {
+            out << "No network loaded, benchmarking random weights\n";
+            initRandom(1);
+        }
+        Backend original = backend;
+
+        static const char *fens[] = {
+            "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+            "3RK1k1/r3P1p1/7p/5r2/5P2/8/8/8 w - - 9 56",
+        };
+        constexpr int Rounds = 2000;
+
+        std::vector<std::unique_ptr<Board>> boards;
+        for (const char *fen : fens)
+            boards.push_back(std::make_unique<Board>(Fen(fen)));
+
+        for (Backend b : { Backend::Scalar, Backend::SSE41, Backend::AVX2 })
+        {
+            if (!cpuSupports(b))
+                continue;
+            setBackend(b);
+
+            u64 incremental = 0, refreshes = 0;
+            long long checksum = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int round = 0; round < Rounds; round++)
+            {
+                for (auto &board : boards)
+                {
+                    if (board->accumulators)
+                        (*board->accumulators)[board->ply].computed = false;
+                    checksum += evaluate(*board); // refresh ở gốc
+                    refreshes++;
+
+                    MoveList moveList;
+                    generateLegalMoves(*board, moveList);
+                    for (const Move &move : moveList)
+                    {
+                        board->doMove(move);
+                        checksum += evaluate(*board); // cập nhật tăng dần từ gốc
+                        board->undoMove(move);
+                        incremental++;
+                    }
+                }
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            u64 evals = incremental + refreshes;
+            out << std::left << std::setw(8) << backendName(b) << std::right
+                << " evals " << evals << " (" << refreshes << " refresh)"
+                << "  time " << std::fixed << std::setprecision(3) << seconds << "s"
+                << "  evals/s " << u64(evals / std::max(seconds, 1e-9))
+                << "  checksum " << checksum << "\n";
+            out.unsetf(std::ios::fixed);
+        }
+
+        setBackend(original);
+        if (!hadNetwork)
+            unload();
+    }
+}
@@ -0,0 +1,154 @@
+#include "PawnTable.h"
+#include "PSQT.h"
+#include <algorithm>
+#include <bit>
+
+namespace ChessEngine
+{
+    namespace
+    {
+        // Thưởng tốt thông theo hàng tương đối (hàng 2 = 1 ... hàng 7 = 6)
+        constexpr int PassedBonus[8] = {
+            makeScore(0, 0), makeScore(5, 10), makeScore(10, 15), makeScore(15, 25),
+            makeScore(25, 45), makeScore(45, 80), makeScore(80, 130), makeScore(0, 0)
+        };
+        constexpr int Isolated = makeScore(-8, -12);
+        constexpr int Doubled = makeScore(-8, -20);
+        constexpr int Backward = makeScore(-6, -10);
+
+        // Lá chắn theo khoảng cách từ vua tới tốt gần nhất trên cùng cột (chỉ trung cuộc)
+        constexpr int ShelterBonus[3] = { makeScore(-20, 0), makeScore(20, 0), makeScore(10, 0) };
+
+        constexpr u64 fileMask(int file) { return AFile << file; }
+
+        constexpr u64 adjacentFiles(int file)
+        {
+            return (file > 0 ? fileMask(file - 1) : 0) | (file < 7 ? fileMask(file + 1) : 0);
+        }
+
+        // Các hàng phía trước ô sq theo hướng đi của color
+        constexpr u64 ranksAhead(ui color, int sq)
+        {
+            int rank = sq / 8;
+            if (color == White)
+                return rank == 7 ? 0 : Universe << (8 * (rank + 1));
+            return rank == 0 ? 0 : Universe >> (8 * (8 - rank));
+        }
+
+        struct PawnMasks {
+            u64 passed[2][64];	// ba cột (cột tốt và hai cột kề), các hàng phía trước
+            u64 forward[2][64]; // cùng cột, các hàng phía trước
+            u64 support[2][64]; // hai cột kề, cùng hàng hoặc phía sau
+        };
+
+        constexpr PawnMasks buildMasks()
+        {
+            PawnMasks masks{};
+            for (ui color = Black; color <= White; color++) {
+                for (int sq = 0; sq < 64; sq++) {
+                    int file = sq % 8;
+                    u64 ahead = ranksAhead(color, sq);
+                    masks.passed[color][sq] = ahead & (fileMask(file) | adjacentFiles(file));
+                    masks.forward[color][sq] = ahead & fileMask(file);
+                    masks.support[color][sq] = ~ahead & adjacentFiles(file);
+                }
+            }
+            return masks;
+        }
+
+        constexpr PawnMasks Masks = buildMasks();
+
+        u64 pawnAttacks(ui color, u64 pawns)
+        {
+            if (color == White)
+                return ((pawns << 9) & ~AFile) | ((pawns << 7) & ~HFile);
+            return ((pawns >> 7) & ~AFile) | ((pawns >> 9) & ~HFile);
+        }
+
+        int relativeRank(ui color, ui sq) { return color == White ? sq / 8 : 7 - sq / 8; }
+
+        // Điểm cấu trúc tốt của một bên (dương = tốt cho bên đó)
+        int evaluatePawns(const Board &board, ui color, PawnEntry &entry)
+        {
+            u64 own = board.pieces[makePiece(color, Pawn)];
+            u64 enemy = board.pieces[makePiece(color ^ 1, Pawn)];
+            u64 enemyAttacks = pawnAttacks(color ^ 1, enemy);
+
+            int score = 0;
+            u64 pawns = own;
+            while (pawns) {
+                ui sq = popLsb(pawns);
+                ui stop = color == White ? sq + 8 : sq - 8;
+                bool doubled = own & Masks.forward[color][sq];
+
+                // Chỉ tốt đi đầu của một cột tốt chồng mới được tính là tốt thông
+                if (!doubled && !(enemy & Masks.passed[color][sq])) {
+                    entry.passed[color] |= squareBB(sq);
+                    score += PassedBonus[relativeRank(color, sq)];
+                }
+
+                if (!(own & adjacentFiles(sq % 8)))
+                    score += Isolated;
+                else if (!(own & Masks.support[color][sq]) && (enemyAttacks & squareBB(stop)))
+                    score += Backward;
+
+                if (doubled)
+                    score += Doubled;
+            }
+            return score;
+        }
+    }
+
+    int PawnEntry::kingShelter(const Board &board, ui color, ui kingSq)
+    {
+        if (kingSquare[color] == kingSq)
+            return shelter[color];
+
+        u64 own = board.pieces[makePiece(color, Pawn)];
+        int file = std::clamp<int>(kingSq % 8, 1, 6);
+        int score = 0;
+        for (int f = file - 1; f <= file + 1; f++) {
+            u64 front = own & Masks.forward[color][kingSq - kingSq % 8 + f];
+            int distance = 0;
+            if (front) {
+                ui nearest = color == White ? lsb(front) : 63 - std::countl_zero(front);
+                distance = relativeRank(color, nearest) - relativeRank(color, kingSq);
+            }
+            score += ShelterBonus[distance >= 1 && distance <= 2 ? distance : 0];
+        }
+
+        kingSquare[color] = kingSq;
+        shelter[color] = score;
+        return score;
+    }
+
+    PawnTable::PawnTable(size_t entryCount)
+        : entries(std::bit_floor(std::max<size_t>(1, entryCount))), mask(entries.size() - 1)
+    {
+    }
+
+    PawnEntry *PawnTable::probe(const Board &board)
+    {
+        u64 key = board.st->pawnKey;
+        PawnEntry &entry = entries[key & mask];
+        probeCount++;
+        // Entry trống có key 0 khớp với thế không còn tốt, và dữ liệu của nó
+        // (điểm 0, không tốt thông) cũng đúng cho thế đó
+        if (entry.key == key) {
+            hitCount++;
+            return &entry;
+        }
+
+        entry = PawnEntry();
+        entry.key = key;
+        entry.score = evaluatePawns(board, White, entry) - evaluatePawns(board, Black, entry);
+        return &entry;
+    }
+
+    void PawnTable::clear()
+    {
+        std::fill(entries.begin(), entries.end(), PawnEntry());
+        probeCount = 0;
+        hitCount = 0;
+    }
+}
@@ -0,0 +1,317 @@
+#include "Perft.h"
+#include "MoveGenerator.h"
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <cstdlib>
+
+namespace ChessEngine
+{
+    namespace
+    {
+        double secondsSince(std::chrono::steady_clock::time_point start)
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        void printSummary(std::ostream &out, const PerftResult &result)
+        {
+            out << "Nodes: " << result.nodes
+                << "  Time: " << std::fixed << std::setprecision(3) << result.seconds << "s"
+                << "  NPS: " << result.nps() << "\n";
+            out.unsetf(std::ios::fixed);
+        }
+
+#ifndef NDEBUG
+        // Bản debug: so khóa Zobrist (và pawnKey) tăng dần với khóa tính lại từ
+        // đầu sau mỗi nước, nên bỏ bulk counting để cả nước lá cũng đi qua doMove
+        constexpr bool verifyKeys = true;
+
+        void verifyZobrist(const Board &board, const Move &move)
+        {
+            u64 expected = board.computeZobrist(*board.st);
+            u64 expectedPawns = board.computePawnKey();
+            if (board.st->zobristKey == expected && board.st->pawnKey == expectedPawns)
+                return;
+            std::cerr << "Zobrist mismatch after " << moveToString(move) << " at ply " << board.ply
+                      << ": incremental " << std::hex << board.st->zobristKey
+                      << ", expected " << expected << "; pawn key " << board.st->pawnKey
+                      << ", expected " << expectedPawns << std::dec << "\n";
+            board.printBoard();
+            std::abort();
+        }
+#else
+        constexpr bool verifyKeys = false;
+
+        inline void verifyZobrist(const Board &, const Move &) {}
+#endif
+
+        u64 hashedPerft(Board &board, int depth, PerftTable &table)
+        {
+            MoveList moveList;
+            generateLegalMoves(board, moveList);
+            if (depth <= 1 && !verifyKeys)
+                return depth == 1 ? moveList.count() : 1;
+            if (depth <= 0)
+                return 1;
+
+            u64 nodes;
+            if (table.probe(board.st->zobristKey, depth, nodes))
+                return nodes;
+
+            nodes = 0;
+            for (const Move &move : moveList)
+            {
+                board.doMove(move);
+                verifyZobrist(board, move);
+                nodes += hashedPerft(board, depth - 1, table);
+                board.undoMove(move);
+            }
+            table.store(board.st->zobristKey, depth, nodes);
+            return nodes;
+        }
+    }
+
+    PerftTable::PerftTable(size_t megabytes)
+    {
+        // Làm tròn xuống lũy thừa của 2 để index bằng phép AND
+        size_t count = std::max<size_t>(1, megabytes * 1024 * 1024 / sizeof(Entry));
+        count = std::bit_floor(count);
+        entries = std::make_unique<Entry[]>(count);
+        mask = count - 1;
+        for (size_t i = 0; i < count; i++)
+        {
+            entries[i].check.store(0, std::memory_order_relaxed);
+            entries[i].data.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    bool PerftTable::probe(u64 key, int depth, u64 &nodes) const
+    {
+        u64 mixed = mixDepth(key, depth);
+        const Entry &entry = entries[mixed & mask];
+        u64 data = entry.data.load(std::memory_order_relaxed);
+        u64 check = entry.check.load(std::memory_order_relaxed);
+        if ((check ^ data) != mixed || (data & 0xFF) != (u64)depth)
+            return false;
+        nodes = data >> 8;
+        hitCount.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void PerftTable::store(u64 key, int depth, u64 nodes)
+    {
+        u64 mixed = mixDepth(key, depth);
+        Entry &entry = entries[mixed & mask];
+        u64 data = (nodes << 8) | (u64)depth;
+        entry.check.store(mixed ^ data, std::memory_order_relaxed);
+        entry.data.store(data, std::memory_order_relaxed);
+    }
+
+    double ParallelPerftResult::scaling() const
+    {
+        double busy = 0.0;
+        for (double t : threadBusy)
+            busy += t;
+        return seconds > 0.0 ? busy / seconds : 1.0;
+    }
+
+    u64 perft(Board &board, int depth)
+    {
+        MoveList moveList;
+        generateLegalMoves(board, moveList);
+
+        // Bulk counting: nước ở depth 1 đều hợp lệ nên không cần doMove
+        if (depth <= 1 && !verifyKeys)
+            return depth == 1 ? moveList.count() : 1;
+        if (depth <= 0)
+            return 1;
+
+        u64 nodes = 0;
+        for (const Move &move : moveList)
+        {
+            board.doMove(move);
+            verifyZobrist(board, move);
+            nodes += perft(board, depth - 1);
+            board.undoMove(move);
+        }
+        return nodes;
+    }
+
+    PerftResult runPerft(Board &board, int depth)
+    {
+        auto start = std::chrono::steady_clock::now();
+        PerftResult result;
+        result.nodes = perft(board, depth);
+        result.seconds = secondsSince(start);
+        return result;
+    }
+
+    ParallelPerftResult parallelPerft(const Board &board, int depth, int threads, PerftTable *table)
+    {
+        auto start = std::chrono::steady_clock::now();
+        threads = std::max(1, threads);
+
+        MoveList rootMoves;
+        generateLegalMoves(board, rootMoves);
+
+        ParallelPerftResult result;
+        result.threadNodes.assign(threads, 0);
+        result.threadBusy.assign(threads, 0.0);
+        u64 hitsBefore = table ? table->hits() : 0;
+
+        if (depth <= 0 || (depth == 1 && !verifyKeys))
+        {
+            result.nodes = depth == 1 ? rootMoves.count() : 1;
+            result.threadNodes[0] = result.nodes;
+            result.seconds = secondsSince(start);
+            return result;
+        }
+
+        // Các luồng lấy nước gốc tiếp theo qua một chỉ số nguyên tử,
+        // nên luồng xong sớm tự nhận thêm việc
+        std::atomic<int> nextMove{ 0 };
+        auto worker = [&](int id)
+        {
+            auto workerStart = std::chrono::steady_clock::now();
+            Board local(board); // stateStack riêng cho mỗi luồng
+            u64 nodes = 0;
+            for (int i = nextMove.fetch_add(1); i < rootMoves.count(); i = nextMove.fetch_add(1))
+            {
+                local.doMove(rootMoves[i]);
+                verifyZobrist(local, rootMoves[i]);
+                nodes += table ? hashedPerft(local, depth - 1, *table) : perft(local, depth - 1);
+                local.undoMove(rootMoves[i]);
+            }
+            result.threadNodes[id] = nodes;
+            result.threadBusy[id] = secondsSince(workerStart);
+        };
+
+        std::vector<std::thread> pool;
+        for (int id = 1; id < threads; id++)
+            pool.emplace_back(worker, id);
+        worker(0);
+        for (std::thread &t : pool)
+            t.join();
+
+        for (u64 nodes : result.threadNodes)
+            result.nodes += nodes;
+        result.seconds = secondsSince(start);
+        result.tableHits = table ? table->hits() - hitsBefore : 0;
+        return result;
+    }
+
+    void printParallelPerft(const ParallelPerftResult &result, std::ostream &out)
+    {
+        for (size_t i = 0; i < result.threadNodes.size(); i++)
+        {
+            out << "Thread " << i << ": " << result.threadNodes[i] << " nodes, busy "
+                << std::fixed << std::setprecision(3) << result.threadBusy[i] << "s\n";
+        }
+        out << "Table hits: " << result.tableHits
+            << "  Scaling: " << std::setprecision(2) << result.scaling() << "x\n";
+        out.unsetf(std::ios::fixed);
+        printSummary(out, result);
+    }
+
+    PerftResult divide(Board &board, int depth, std::ostream &out)
+    {
+        auto start = std::chrono::steady_clock::now();
+        PerftResult result;
+
+        MoveList moveList;
+        generateLegalMoves(board, moveList);
+        for (const Move &move : moveList)
+        {
+            board.doMove(move);
+            verifyZobrist(board, move);
+            u64 nodes = depth > 1 ? perft(board, depth - 1) : 1;
+            board.undoMove(move);
+
+            out << moveToString(move) << ": " << nodes << "\n";
+            result.nodes += nodes;
+        }
+
+        result.seconds = secondsSince(start);
+        out << "\nMoves: " << moveList.count() << "\n";
+        printSummary(out, result);
+        return result;
+    }
+
+    const std::vector<PerftPosition> &perftSuite()
+    {
+        // Số nút tham chiếu từ Chess Programming Wiki ("Perft Results") và bộ
+        // vị trí hiểm của Peter Ellis Jones (số nút ở độ sâu lớn nhất khớp số
+        // đã công bố); hai vị trí cuối lấy từ myGame.txt.
+        static const std::vector<PerftPosition> suite = {
+            { "startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+                { 20, 400, 8902, 197281, 4865609, 119060324 } },
+            { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                { 48, 2039, 97862, 4085603, 193690690 } },
+            { "position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+                { 14, 191, 2812, 43238, 674624, 11030083, 178633661 } },
+            { "position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+                { 6, 264, 9467, 422333, 15833292 } },
+            { "position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+                { 44, 1486, 62379, 2103487, 89941194 } },
+            { "position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+                { 46, 2079, 89890, 3894594, 164075551 } },
+            // Bắt qua đường làm lộ vua theo hàng ngang / bắt qua đường chiếu vua
+            { "epPin", "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1",
+                { 18, 92, 1670, 10138, 185429, 1134888 } },
+            { "epCheck", "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",
+                { 15, 126, 1928, 13931, 206379, 1440467 } },
+            // Mất quyền nhập thành khi xe bị ăn / không nhập thành qua ô bị kiểm soát
+            { "castling", "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1",
+                { 26, 1141, 27826, 1274206 } },
+            { "noCastle", "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1",
+                { 44, 1494, 50509, 1720476 } },
+            // Phong cấp thoát chiếu / phong cấp dưới để chiếu
+            { "promoCheck", "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1",
+                { 11, 133, 1442, 19174, 266199, 3821001 } },
+            { "underPromo", "8/P1k5/K7/8/8/8/8/8 w - - 0 1",
+                { 6, 27, 273, 1329, 18135, 92683 } },
+            { "myGame1", "3RK1k1/r3P1p1/7p/5r2/5P2/8/8/8 w - - 9 56",
+                { 10, 266, 3132, 81394, 1056596, 27186918 } },
+            // Đen bị chiếu hết: chỉ kiểm tra thế không còn nước nào, không đo perft
+            { "myGame2", "r2r1k2/ppR2Qp1/1q2pp1p/3p4/8/3P4/PP3PPP/2R3K1 b - - 1 24",
+                { 0 } },
+        };
+        return suite;
+    }
+
+    bool runPerftSuite(int maxDepth, int threads, size_t hashMB, std::ostream &out)
+    {
+        bool allPassed = true;
+        PerftResult total;
+        bool parallel = threads > 1 || hashMB > 0;
+        std::unique_ptr<PerftTable> table;
+        if (hashMB > 0)
+            table = std::make_unique<PerftTable>(hashMB);
+
+        for (const PerftPosition &position : perftSuite())
+        {
+            Board board{ Fen(position.fen) };
+            int depth = std::clamp<int>(maxDepth, 1, (int)position.expected.size());
+            PerftResult result = parallel ? parallelPerft(board, depth, threads, table.get()) : runPerft(board, depth);
+            u64 expected = position.expected[depth - 1];
+            bool passed = result.nodes == expected;
+            allPassed &= passed;
+
+            total.nodes += result.nodes;
+            total.seconds += result.seconds;
+
+            out << std::left << std::setw(11) << position.name << " depth " << depth
+                << std::right << "  " << (passed ? "OK  " : "FAIL") << "  ";
+            if (!passed)
+                out << "(expected " << expected << ") ";
+            printSummary(out, result);
+        }
+
+        out << "\nTotal ";
+        printSummary(out, total);
+        out << (allPassed ? "All positions passed\n" : "Some positions FAILED\n");
+        return allPassed;
+    }
+}
@@ -0,0 +1,258 @@
+#include "SEE.h"
+#include "AttackTable.h"
+#include "Evaluator.h"
+#include "MoveGenerator.h"
+#include "Search.h"
+#include <chrono>
+#include <iomanip>
+
+namespace ChessEngine
+{
+    namespace
+    {
+        // Vua "vô giá": không bao giờ là quân rẻ nhất khi còn quân khác
+        constexpr int KingValue = 20000;
+
+        int typeValue(ui type) { return type == King ? KingValue : pieceValue[type]; }
+
+        // Giá trị quân đứng trên ô đích sau move (có thể bị ăn lại)
+        int movedValue(const Board &board, Move move)
+        {
+            if (move.isPromotion())
+                return pieceValue[move.promotionType()];
+            return typeValue(typeOf(board.piecesList[move.from()]));
+        }
+
+        // Occupancy sau khi quân đi rời from (và tốt bị ăn qua đường biến mất)
+        u64 occupancyAfter(const Board &board, Move move)
+        {
+            u64 occupied = board.occupancy() ^ squareBB(move.from());
+            if (move.isEnPassant())
+                occupied ^= squareBB(board.st->activeColor == White ? move.to() - 8 : move.to() + 8);
+            return occupied;
+        }
+
+        // Quân trượt lộ ra phía sau sau khi occupied thay đổi
+        u64 sliderAttackers(const Board &board, ui square, u64 occupied)
+        {
+            u64 diagonal = board.pieces[WhiteBishop] | board.pieces[BlackBishop]
+                | board.pieces[WhiteQueen] | board.pieces[BlackQueen];
+            u64 straight = board.pieces[WhiteRook] | board.pieces[BlackRook]
+                | board.pieces[WhiteQueen] | board.pieces[BlackQueen];
+            return (bishopAttacks(square, occupied) & diagonal) | (rookAttacks(square, occupied) & straight);
+        }
+
+        // Quân của side có thể ăn lại; quân bị ghim đứng ngoài khi quân ghim còn trên bàn
+        u64 sideAttackers(const Board &board, u64 attackers, ui side, u64 occupied)
+        {
+            u64 own = attackers & board.colorPieces(side);
+            if (board.pinners(side ^ 1) & occupied)
+                own &= ~board.pinned(side);
+            return own;
+        }
+
+        // Ô của quân tấn công rẻ nhất của color trong attackers, loại quân trả về qua type
+        ui leastValuableAttacker(const Board &board, u64 attackers, ui color, ui &type)
+        {
+            for (type = Pawn; type <= King; type++)
+            {
+                u64 bb = attackers & board.pieces[makePiece(color, type)];
+                if (bb)
+                    return lsb(bb);
+            }
+            return NoSquare;
+        }
+
+        struct SeePosition
+        {
+            const char *fen;
+            const char *move;
+            int expected;
+        };
+
+        // Giá trị mong đợi tính tay theo pieceValue (P100 N320 B330 R500 Q900).
+        // Phần lớn lấy từ bộ SEE kinh điển, đổi giá trị sang bảng của engine.
+        const SeePosition seeSuite[] = {
+            { "1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1e5", 100 },
+            { "1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "d3e5", -220 },
+            { "4R3/2r3p1/5bk1/1p1r3p/p2PR1P1/P1BK1P2/1P6/8 b - - 0 1", "h5g4", 0 },
+            { "4R3/2r3p1/5bk1/1p1r1p1p/p2PR1P1/P1BK1P2/1P6/8 b - - 0 1", "h5g4", 0 },
+            { "4r1k1/5pp1/nbp4p/1p2p2q/1P2P1b1/1BP2N1P/1B2QPPK/3R4 b - - 0 1", "g4f3", -10 },
+            { "2r1r1k1/pp1bppbp/3p1np1/q3P3/2P2P2/1P2B3/P1N1B1PP/2RQ1RK1 b - - 0 1", "d6e5", 100 },
+            { "7r/5qpk/p1Qp1b1p/3r3n/BB3p2/5p2/P1P2P2/4RK1R w - - 0 1", "e1e8", 0 },
+            { "6rr/6pk/p1Qp1b1p/2n5/1B3p2/5p2/P1P2P2/4RK1R w - - 0 1", "e1e8", -500 },
+            { "7r/5qpk/2Qp1b1p/1N1r3n/BB3p2/5p2/P1P2P2/4RK1R w - - 0 1", "e1e8", -500 },
+            { "6RR/4bP2/8/8/5r2/3K4/5p2/4k3 w - - 0 1", "f7f8q", 230 },
+            { "4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6", 100 },
+            { "4k3/8/8/8/8/8/3q4/3RK3 b - - 0 1", "d2d1", -400 },
+            { "4k3/8/8/8/8/5b2/3q4/3RK3 b - - 0 1", "d2d1", 500 },
+            { "4k3/8/8/8/2p5/8/8/2N1K3 w - - 0 1", "c1d3", -320 },
+            { "1n2k3/P7/8/8/8/8/8/4K3 w - - 0 1", "a7b8q", 1120 },
+            { "1nk5/P7/8/8/8/8/8/4K3 w - - 0 1", "a7b8q", 220 },
+        };
+    }
+
+    int captureGain(const Board &board, Move move)
+    {
+        int gain = 0;
+        if (move.isEnPassant())
+            gain = pieceValue[Pawn];
+        else if (board.piecesList[move.to()] != NoPiece)
+            gain = typeValue(typeOf(board.piecesList[move.to()]));
+        if (move.isPromotion())
+            gain += pieceValue[move.promotionType()] - pieceValue[Pawn];
+        return gain;
+    }
+
+    int see(const Board &board, Move move)
+    {
+        if (move.isCastling())
+            return 0;
+
+        ui to = move.to();
+        int gain[32];
+        int depth = 0;
+        gain[0] = captureGain(board, move);
+        int onSquare = movedValue(board, move);
+
+        u64 occupied = occupancyAfter(board, move);
+        u64 attackers = board.attackersTo(to, occupied) & occupied;
+        ui side = board.st->activeColor ^ 1;
+
+        while (true)
+        {
+            ui type;
+            ui from = leastValuableAttacker(board, sideAttackers(board, attackers, side, occupied), side, type);
+            if (from == NoSquare)
+                break;
+            // Vua không được ăn vào ô còn bị đối phương tấn công
+            if (type == King && (attackers & board.colorPieces(side ^ 1)))
+                break;
+
+            depth++;
+            gain[depth] = onSquare - gain[depth - 1];
+
+            onSquare = typeValue(type);
+            occupied ^= squareBB(from);
+            attackers = (attackers | sliderAttackers(board, to, occupied)) & occupied;
+            side ^= 1;
+        }
+
+        // Mỗi bên được quyền dừng ăn lại nếu tiếp tục là thiệt
+        while (depth > 0)
+        {
+            gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+            depth--;
+        }
+        return gain[0];
+    }
+
+    bool seeGe(const Board &board, Move move, int threshold)
+    {
+        if (move.isCastling())
+            return 0 >= threshold;
+
+        // swap: điểm bên vừa đi còn dư so với threshold nếu đối phương ăn lại
+        int swap = captureGain(board, move) - threshold;
+        if (swap < 0)
+            return false;
+        swap = movedValue(board, move) - swap;
+        if (swap <= 0)
+            return true;
+
+        ui to = move.to();
+        u64 occupied = occupancyAfter(board, move);
+        u64 attackers = board.attackersTo(to, occupied);
+        ui side = board.st->activeColor;
+        bool result = true;
+
+        while (true)
+        {
+            side ^= 1;
+            attackers &= occupied;
+            u64 own = sideAttackers(board, attackers, side, occupied);
+            if (!own)
+                break;
+            result = !result;
+
+            ui type;
+            ui from = leastValuableAttacker(board, own, side, type);
+            if (type == King)
+                // Vua ăn được chỉ khi bên kia hết quân tấn công
+                return (attackers & board.colorPieces(side ^ 1)) ? !result : result;
+
+            swap = typeValue(type) - swap;
+            if (swap < (int)result)
+                break;
+
+            occupied ^= squareBB(from);
+            attackers |= sliderAttackers(board, to, occupied);
+        }
+        return result;
+    }
+
+    bool runSeeSuite(std::ostream &out)
+    {
+        bool allPassed = true;
+        int index = 0;
+        for (const SeePosition &position : seeSuite)
+        {
+            index++;
+            auto board = std::make_unique<Board>(Fen(position.fen));
+            Move move = parseMove(*board, position.move);
+            int value = move.isNone() ? 0 : see(*board, move);
+            bool thresholdOk = !move.isNone() && seeGe(*board, move, position.expected)
+                && !seeGe(*board, move, position.expected + 1);
+            bool passed = !move.isNone() && value == position.expected && thresholdOk;
+            allPassed &= passed;
+
+            out << std::setw(2) << index << "  " << std::left << std::setw(6) << position.move << std::right
+                << (passed ? "OK  " : "FAIL") << "  see " << std::setw(5) << value
+                << "  expected " << std::setw(5) << position.expected;
+            if (!thresholdOk)
+                out << "  (seeGe mismatch)";
+            out << "  " << position.fen << "\n";
+        }
+        out << (allPassed ? "All positions passed\n" : "Some positions FAILED\n");
+        return allPassed;
+    }
+
+    void runSeeBench(std::ostream &out)
+    {
+        // Gom các nước ăn quân từ bộ bench và các vị trí SEE
+        std::vector<std::unique_ptr<Board>> boards;
+        std::vector<std::pair<int, Move>> captures;
+        std::vector<std::string> fens = benchPositions();
+        for (const SeePosition &position : seeSuite)
+            fens.push_back(position.fen);
+        for (const std::string &fen : fens)
+        {
+            boards.push_back(std::make_unique<Board>(Fen(fen)));
+            MoveList moveList;
+            generateCaptures(*boards.back(), moveList);
+            for (const Move &move : moveList)
+                captures.emplace_back((int)boards.size() - 1, move);
+        }
+
+        constexpr int Rounds = 20000;
+        auto measure = [&](const char *name, auto &&function)
+        {
+            long long checksum = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int round = 0; round < Rounds; round++)
+                for (const auto &[index, move] : captures)
+                    checksum += function(*boards[index], move);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            double calls = (double)Rounds * captures.size();
+            out << std::left << std::setw(8) << name << std::right << "  calls " << (u64)calls
+                << "  time " << std::fixed << std::setprecision(3) << seconds << "s"
+                << "  ns/call " << std::setprecision(1) << seconds * 1e9 / calls
+                << "  checksum " << checksum << "\n";
+            out.unsetf(std::ios::fixed);
+        };
+
+        out << captures.size() << " captures from " << boards.size() << " positions\n";
+        measure("see", [](const Board &board, Move move) { return see(board, move); });
+        measure("seeGe", [](const Board &board, Move move) { return (int)seeGe(board, move, 0); });
+    }
+}
@@ -0,0 +1,949 @@
+﻿#include "Search.h"
+#include "MoveGenerator.h"
+#include "Evaluator.h"
+#include "TranspositionTable.h"
+#include "SEE.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <thread>
+
+namespace ChessEngine
+{
+    namespace
+    {
+        // Điểm chiếu hết (và thắng/thua theo bảng tàn cuộc) lưu trong TT tính
+        // từ nút hiện tại, không phải từ gốc
+        int valueToTT(int score, int ply)
+        {
+            if (score >= VALUE_TB_WIN_IN_MAX_PLY) return score + ply;
+            if (score <= -VALUE_TB_WIN_IN_MAX_PLY) return score - ply;
+            return score;
+        }
+
+        int valueFromTT(int score, int ply)
+        {
+            if (score >= VALUE_TB_WIN_IN_MAX_PLY) return score - ply;
+            if (score <= -VALUE_TB_WIN_IN_MAX_PLY) return score + ply;
+            return score;
+        }
+
+        // Lịch bỏ độ sâu cho luồng phụ: luồng i bỏ qua các độ sâu sao cho
+        // các luồng không cùng tìm một độ sâu tại cùng thời điểm
+        constexpr int SkipSize[] = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+        constexpr int SkipPhase[] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+        // LMR: độ giảm cơ sở theo log(depth) * log(moveCount)
+        const auto reductionTable = []
+        {
+            std::array<std::array<int, 64>, MAX_DEPTH + 1> table{};
+            for (int depth = 1; depth <= MAX_DEPTH; depth++)
+                for (int count = 1; count < 64; count++)
+                    table[depth][count] = int(0.75 + std::log(depth) * std::log(count) / 2.25);
+            return table;
+        }();
+
+        const std::vector<SearchFeatureOption> featureOptions = {
+            { "NullMove", &SearchFeatures::nullMove },
+            { "LMR", &SearchFeatures::lmr },
+            { "ReverseFutility", &SearchFeatures::reverseFutility },
+            { "Futility", &SearchFeatures::futility },
+            { "LMP", &SearchFeatures::lmp },
+            { "Razoring", &SearchFeatures::razoring },
+            { "CheckExtension", &SearchFeatures::checkExtension },
+            { "SingularExtension", &SearchFeatures::singularExtension },
+        };
+    }
+
+    const std::vector<SearchFeatureOption> &searchFeatureOptions()
+    {
+        return featureOptions;
+    }
+
+    Searcher::Searcher(const Board &rootBoard, SearchShared *sharedState, int id, PawnTable *pawnTable)
+        : board(rootBoard), histories(std::make_unique<SearchHistories>()),
+          shared(sharedState ? sharedState : &ownShared), threadId(id), pawns(pawnTable)
+    {
+        if (!pawns)
+        {
+            ownPawns = std::make_unique<PawnTable>();
+            pawns = ownPawns.get();
+        }
+        pvLength[0] = 0;
+    }
+
+    bool Searcher::skipDepth(int depth) const
+    {
+        if (threadId == 0 || depth == 1)
+            return false;
+        int i = (threadId - 1) % 20;
+        return ((depth + SkipPhase[i]) / SkipSize[i]) % 2 != 0;
+    }
+
+    u64 Searcher::totalNodes() const
+    {
+        return shared->nodes.load(std::memory_order_relaxed) + (nodes - flushedNodes);
+    }
+
+    int Searcher::elapsedMs() const
+    {
+        return (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    void Searcher::checkLimits()
+    {
+        shared->nodes.fetch_add(nodes - flushedNodes, std::memory_order_relaxed);
+        flushedNodes = nodes;
+
+        if (limits.infinite || shared->ponder.load(std::memory_order_relaxed))
+            return;
+        if (limits.nodes && shared->nodes.load(std::memory_order_relaxed) >= limits.nodes)
+            shared->stop = true;
+        if (timeManager.enabled() && elapsedMs() >= timeManager.maximum())
+            shared->stop = true;
+    }
+
+    // Hòa do lặp lại (một lần là đủ nếu thế cũ nằm trong cây) hoặc không đủ
+    // quân; luật 50 nước xét sau khi sinh nước vì chiếu hết ở nước thứ 100 vẫn
+    // được ưu tiên.
+    bool Searcher::isDraw(int ply) const
+    {
+        return board.isDrawByRepetition(ply) || board.isDrawByInsufficientMaterial();
+    }
+
+    // Xếp hạng nước ở gốc bằng bảng tàn cuộc (DTZ, thiếu thì WDL) và chỉ giữ
+    // các nước hạng tốt nhất. Có DTZ thì gốc đã giữ được tiến triển nên không
+    // cần dò thêm trong cây; chỉ có WDL mà đang thắng thì vẫn dò để search tìm
+    // đường thắng.
+    void Searcher::rankRootMoves(const MoveList &rootMoves)
+    {
+        std::vector<Syzygy::RootMove> ranked;
+        for (const Move &move : rootMoves)
+            ranked.push_back({ move });
+
+        bool dtzAvailable;
+        if (!Syzygy::rankRootMoves(board, ranked, limits.syzygy50MoveRule, dtzAvailable))
+            return;
+
+        tbHits += ranked.size();
+        std::stable_sort(ranked.begin(), ranked.end(),
+            [](const Syzygy::RootMove &a, const Syzygy::RootMove &b) { return a.rank > b.rank; });
+        for (const Syzygy::RootMove &root : ranked)
+            if (root.rank == ranked[0].rank)
+                rootTbMoves.push_back(packMove(root.move));
+
+        rootInTB = true;
+        rootTbScore = ranked[0].score;
+        if (dtzAvailable || rootTbScore <= VALUE_DRAW)
+            tbProbeLimit = 0;
+    }
+
+    bool Searcher::isRootTbMove(Move move) const
+    {
+        return std::find(rootTbMoves.begin(), rootTbMoves.end(), packMove(move)) != rootTbMoves.end();
+    }
+
+    SearchInfo Searcher::think(const SearchLimits &searchLimits)
+    {
+        limits = searchLimits;
+        startTime = std::chrono::steady_clock::now();
+        timeManager.init(limits, board.st->activeColor);
+        std::memset(rootMoveNodes, 0, sizeof(rootMoveNodes));
+        std::fill(std::begin(stack), std::end(stack), SearchStack());
+        betaCutoffs = firstMoveCutoffs = 0;
+        nodes = qnodes = tbHits = 0;
+        flushedNodes = 0;
+        previousPvLength = 0;
+        rootInTB = false;
+        rootTbMoves.clear();
+        tbProbeLimit = std::min(limits.syzygyProbeLimit, Syzygy::maxPieces());
+
+        SearchInfo result;
+        MoveList rootMoves;
+        generateLegalMoves(board, rootMoves);
+        if (rootMoves.count() == 0)
+        {
+            result.score = board.inCheck() ? -VALUE_MATE : VALUE_DRAW;
+            return result;
+        }
+        // Luôn có nước để trả về kể cả khi bị dừng ngay ở depth 1
+        result.bestMove = rootMoves[0];
+
+        // Bảng không chứa thế còn quyền nhập thành
+        if (std::popcount(board.occupancy()) <= tbProbeLimit && board.st->castling == 0)
+        {
+            rankRootMoves(rootMoves);
+            if (rootInTB)
+                result.bestMove = Move::fromRaw(rootTbMoves[0]);
+        }
+
+        int score = 0;
+        int maxDepth = std::min(limits.depth, MAX_DEPTH);
+        for (int depth = 1; depth <= maxDepth; depth++)
+        {
+            if (skipDepth(depth))
+                continue;
+
+            rootDepth = depth;
+            score = aspiration(depth, score);
+
+            // Vòng bị dừng giữa chừng: giữ kết quả của vòng trước
+            if (stopped())
+                break;
+
+            previousPvLength = pvLength[0];
+            std::copy(pvTable[0], pvTable[0] + pvLength[0], previousPv);
+
+            // result.bestMove vẫn là nước của vòng trước, previousPv đã là PV mới
+            bool bestMoveChanged = previousPvLength == 0 || !(previousPv[0] == result.bestMove);
+
+            result.depth = depth;
+            result.score = rootInTB && std::abs(score) < VALUE_MATE_IN_MAX_PLY ? rootTbScore : score;
+            result.nodes = totalNodes();
+            result.qnodes = qnodes;
+            result.tbHits = tbHits;
+            result.timeMs = elapsedMs();
+            result.hashfull = TT.hashfull();
+            result.betaCutoffs = betaCutoffs;
+            result.firstMoveCutoffs = firstMoveCutoffs;
+            result.pv.assign(previousPv, previousPv + previousPvLength);
+            if (previousPvLength > 0)
+                result.bestMove = previousPv[0];
+
+            if (onIteration)
+                onIteration(result);
+
+            // Giới hạn mềm: chỉ luồng chính quyết định, và không khi đang ponder
+            if (threadId == 0 && !shared->ponder.load(std::memory_order_relaxed))
+            {
+                const Move &best = result.bestMove;
+                double fraction = nodes ? (double)rootMoveNodes[best.from()][best.to()] / nodes : 1.0;
+                if (timeManager.stopAfterIteration(result.timeMs, bestMoveChanged && depth > 1, score, fraction))
+                {
+                    shared->stop = true;
+                    break;
+                }
+            }
+        }
+
+        shared->nodes.fetch_add(nodes - flushedNodes, std::memory_order_relaxed);
+        flushedNodes = nodes;
+        result.nodes = nodes;
+        result.qnodes = qnodes;
+        result.tbHits = tbHits;
+        result.timeMs = elapsedMs();
+        return result;
+    }
+
+    int Searcher::aspiration(int depth, int previousScore)
+    {
+        if (depth < ASPIRATION_MIN_DEPTH || std::abs(previousScore) >= VALUE_MATE_IN_MAX_PLY)
+            return negamax(-VALUE_INFINITE, VALUE_INFINITE, depth, 0);
+
+        int delta = ASPIRATION_WINDOW;
+        int alpha = std::max(previousScore - delta, -VALUE_INFINITE);
+        int beta = std::min(previousScore + delta, VALUE_INFINITE);
+
+        while (true)
+        {
+            int score = negamax(alpha, beta, depth, 0);
+            if (stopped())
+                return score;
+
+            if (score <= alpha)
+                alpha = std::max(score - delta, -VALUE_INFINITE);
+            else if (score >= beta)
+                beta = std::min(score + delta, VALUE_INFINITE);
+            else
+                return score;
+
+            // Mở rộng cửa sổ theo cấp số nhân, quá rộng thì tìm full window
+            delta *= 2;
+            if (delta > 16 * ASPIRATION_WINDOW)
+            {
+                alpha = -VALUE_INFINITE;
+                beta = VALUE_INFINITE;
+            }
+        }
+    }
+
+    int Searcher::negamax(int alpha, int beta, int depth, int ply)
+    {
+        if (depth <= 0)
+            return qsearch(alpha, beta, ply);
+
+        pvLength[ply] = ply;
+
+        if ((++nodes & (TIME_CHECK_NODES - 1)) == 0)
+            checkLimits();
+        if (stopped())
+            return 0;
+
+        if (ply > 0 && isDraw(ply))
+            return VALUE_DRAW;
+
+        // Bên đi có thể ép lặp nước ngay: hòa là cận dưới, cắt trước khi đi nước đó
+        if (ply > 0 && alpha < VALUE_DRAW && board.hasUpcomingRepetition(ply))
+        {
+            alpha = VALUE_DRAW;
+            if (alpha >= beta)
+                return alpha;
+        }
+
+        if (ply >= MAX_SEARCH_PLY - 1 || board.ply >= MAX_PLY - 1)
+            return evaluate(board, *pawns);
+
+        const SearchFeatures &features = limits.features;
+        bool pvNode = beta - alpha > 1;
+        u64 key = board.st->zobristKey;
+        SearchStack *ss = &stack[ply + 2];
+        Move excludedMove = ss->excludedMove;
+
+        TTData ttData;
+        bool ttHit = TT.probe(key, ttData);
+        int ttScore = ttHit ? valueFromTT(ttData.score, ply) : VALUE_NONE;
+        // Tìm kiếm singular loại bỏ ttMove nên không được dùng entry của chính nút này
+        if (ttHit && excludedMove.isNone() && !pvNode && ply > 0 && ttData.depth >= depth)
+        {
+            if (ttData.bound == BoundExact
+                || (ttData.bound == BoundLower && ttScore >= beta)
+                || (ttData.bound == BoundUpper && ttScore <= alpha))
+                return ttScore;
+        }
+
+        // Bảng tàn cuộc: chỉ dò ngay sau nước ăn quân/đi tốt vì các thế sau đó
+        // cùng vật chất đã có kết quả trong TT. Thắng/thua là cận, chỉ cắt khi
+        // cận đó nằm ngoài cửa sổ; ở nút PV nó giới hạn điểm trả về.
+        int bestScore = -VALUE_INFINITE;
+        int maxScore = VALUE_INFINITE;
+        if (ply > 0 && tbProbeLimit && excludedMove.isNone() && board.st->halfMove == 0 && board.st->castling == 0)
+        {
+            int pieceCount = std::popcount(board.occupancy());
+            // Dò WDL đi thử các nước ăn quân: chừa chỗ trong stateStack
+            if (pieceCount <= tbProbeLimit && (pieceCount < tbProbeLimit || depth >= limits.syzygyProbeDepth)
+                && board.ply + Syzygy::MAX_PIECES < MAX_PLY)
+            {
+                Syzygy::ProbeState state;
+                Syzygy::WDLScore wdl = Syzygy::probeWdl(board, state);
+                if (state != Syzygy::ProbeFail)
+                {
+                    tbHits++;
+                    int drawScore = limits.syzygy50MoveRule ? 1 : 0;
+                    int score = wdl < -drawScore ? -VALUE_TB_WIN + ply
+                        : wdl > drawScore ? VALUE_TB_WIN - ply
+                        : VALUE_DRAW + 2 * wdl * drawScore;
+                    Bound bound = wdl < -drawScore ? BoundUpper
+                        : wdl > drawScore ? BoundLower : BoundExact;
+
+                    if (bound == BoundExact || (bound == BoundLower ? score >= beta : score <= alpha))
+                    {
+                        TT.store(key, 0, valueToTT(score, ply), std::min(MAX_DEPTH, depth + 6), bound);
+                        return score;
+                    }
+                    if (pvNode)
+                    {
+                        if (bound == BoundLower)
+                        {
+                            bestScore = score;
+                            alpha = std::max(alpha, score);
+                        }
+                        else
+                            maxScore = score;
+                    }
+                }
+            }
+        }
+
+        bool inCheck = board.inCheck();
+
+        // Luật 50 nước: hòa, trừ khi nước thứ 100 vừa chiếu hết
+        if (ply > 0 && board.fiftyMoveRule())
+        {
+            MoveList evasions;
+            if (inCheck)
+                generateEvasions(board, evasions);
+            return inCheck && evasions.count() == 0 ? -VALUE_MATE + ply : VALUE_DRAW;
+        }
+
+        // Đánh giá tĩnh, tinh chỉnh bằng điểm TT nếu bound cho phép
+        int eval = VALUE_NONE;
+        bool improving = false;
+        if (inCheck)
+            ss->staticEval = VALUE_NONE;
+        else
+        {
+            eval = ss->staticEval = evaluate(board, *pawns);
+            if (ttHit && ttScore != VALUE_NONE && (ttData.bound & (ttScore > eval ? BoundLower : BoundUpper)))
+                eval = ttScore;
+            improving = (ss - 2)->staticEval != VALUE_NONE && ss->staticEval > (ss - 2)->staticEval;
+        }
+
+        bool prune = !pvNode && !inCheck && excludedMove.isNone();
+
+        // Reverse futility: eval vượt beta một biên theo độ sâu, coi như fail-high
+        if (prune && features.reverseFutility && depth <= 8 && std::abs(eval) < VALUE_MATE_IN_MAX_PLY
+            && eval - 80 * (depth - improving) >= beta)
+            return eval;
+
+        // Razoring: eval quá thấp so với alpha, chỉ còn hy vọng ở nước chiến thuật
+        if (prune && features.razoring && depth <= 3 && eval + 300 + 250 * depth < alpha)
+        {
+            int score = qsearch(alpha - 1, alpha, ply);
+            if (score < alpha)
+                return score;
+        }
+
+        // Null move: nhường nước mà vẫn >= beta thì nước thật gần như chắc chắn cũng vậy.
+        // Không dùng khi bên đi chỉ còn tốt (dễ zugzwang) hoặc ngay sau một null move.
+        if (prune && features.nullMove && depth >= 3 && eval >= beta && !(ss - 1)->move.isNone()
+            && board.hasNonPawnMaterial(board.st->activeColor))
+        {
+            int reduction = 3 + depth / 3 + std::min((eval - beta) / 200, 3);
+            ss->move = Move();
+            ss->movedPiece = NoPiece;
+            ss->contHist = nullptr;
+            board.doNullMove();
+            int score = -negamax(-beta, -beta + 1, depth - reduction, ply + 1);
+            board.undoNullMove();
+
+            if (stopped())
+                return 0;
+            if (score >= beta)
+                return score >= VALUE_MATE_IN_MAX_PLY ? beta : score;
+        }
+
+        // Nước từ TT (hoặc PV của vòng trước) được thử đầu tiên
+        Move ttMove = ttHit ? Move::fromRaw(ttData.move)
+            : ply < previousPvLength ? previousPv[ply] : Move();
+
+        const PieceToHistory *continuation[2] = { (ss - 1)->contHist, (ss - 2)->contHist };
+        Move counterMove = (ss - 1)->move.isNone() ? Move()
+            : histories->counterMoves.table[(ss - 1)->movedPiece][(ss - 1)->move.to()];
+        MovePicker picker(board, ttMove, ss->killers, counterMove, &histories->butterfly, continuation);
+
+        int originalAlpha = alpha;
+        Move bestMove;
+        Move quietsTried[64];
+        int quietCount = 0;
+        int moveCount = 0;
+        for (Move move = picker.next(); !move.isNone(); move = picker.next())
+        {
+            if (move == excludedMove)
+                continue;
+            if (ply == 0 && rootInTB && !isRootTbMove(move))
+                continue;
+
+            moveCount++;
+            bool quiet = !isTactical(move);
+            bool refutation = move == ss->killers[0] || move == ss->killers[1] || move == counterMove;
+            int history = quiet ? quietHistory(ss, move) : 0;
+
+            // Late move pruning: đủ nhiều quiet đã thử ở độ sâu thấp thì bỏ phần còn lại
+            bool canPrune = ply > 0 && !inCheck && quiet && bestScore > -VALUE_MATE_IN_MAX_PLY;
+            if (canPrune && features.lmp && !pvNode && depth <= 8
+                && moveCount > (3 + depth * depth) / (2 - improving))
+                continue;
+
+            // Singular extension: ttMove tốt hơn hẳn mọi nước khác thì tìm sâu thêm;
+            // nếu nhiều nước cùng vượt beta (multi-cut) thì cắt luôn
+            int extension = 0;
+            if (features.singularExtension && ply > 0 && depth >= 8 && move == ttMove && excludedMove.isNone()
+                && ttHit && (ttData.bound & BoundLower) && ttData.depth >= depth - 3
+                && std::abs(ttScore) < VALUE_MATE_IN_MAX_PLY)
+            {
+                int singularBeta = ttScore - 2 * depth;
+                ss->excludedMove = move;
+                int score = negamax(singularBeta - 1, singularBeta, (depth - 1) / 2, ply);
+                ss->excludedMove = Move();
+                pvLength[ply] = ply;
+
+                if (stopped())
+                    return 0;
+                if (score < singularBeta)
+                    extension = 1;
+                else if (singularBeta >= beta)
+                    return singularBeta;
+            }
+
+            u64 nodesBefore = nodes;
+            ss->move = move;
+            ss->movedPiece = board.piecesList[move.from()];
+            ss->contHist = &histories->continuation.table[ss->movedPiece][move.to()];
+            board.doMove(move);
+            bool givesCheck = board.inCheck();
+
+            // Futility: eval cộng biên theo độ sâu vẫn không tới alpha, nước yên lặng
+            // không chiếu gần như không cứu được
+            if (canPrune && features.futility && !givesCheck && depth <= 6
+                && eval + 100 + 120 * depth <= alpha)
+            {
+                board.undoMove(move);
+                continue;
+            }
+
+            // Chiếu: tìm thêm một ply, giới hạn để cây không phình vô hạn
+            if (features.checkExtension && givesCheck && extension == 0 && ply < 2 * rootDepth)
+                extension = 1;
+
+            int newDepth = depth - 1 + extension;
+            int score;
+            if (moveCount == 1)
+                score = -negamax(-beta, -alpha, newDepth, ply + 1);
+            else
+            {
+                // LMR: nước xếp sau được tìm nông hơn, history tốt thì giảm ít hơn
+                int reduction = 0;
+                if (features.lmr && depth >= 3 && moveCount > 1 + pvNode && quiet)
+                {
+                    reduction = reductionTable[std::min(depth, MAX_DEPTH)][std::min(moveCount, 63)];
+                    reduction += !improving;
+                    reduction -= pvNode;
+                    reduction -= refutation;
+                    reduction -= givesCheck;
+                    reduction -= history / 8192;
+                    reduction = std::clamp(reduction, 0, newDepth - 1);
+                }
+
+                // PVS: cửa sổ rỗng trước, chỉ tìm lại khi nước có vẻ tốt hơn
+                score = -negamax(-alpha - 1, -alpha, newDepth - reduction, ply + 1);
+                if (score > alpha && reduction > 0)
+                    score = -negamax(-alpha - 1, -alpha, newDepth, ply + 1);
+                if (score > alpha && score < beta)
+                    score = -negamax(-beta, -alpha, newDepth, ply + 1);
+            }
+
+            board.undoMove(move);
+
+            if (ply == 0)
+                rootMoveNodes[move.from()][move.to()] += nodes - nodesBefore;
+
+            if (stopped())
+                return 0;
+
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestMove = move;
+                if (score > alpha)
+                {
+                    alpha = score;
+
+                    pvTable[ply][ply] = move;
+                    for (int next = ply + 1; next < pvLength[ply + 1]; next++)
+                        pvTable[ply][next] = pvTable[ply + 1][next];
+                    pvLength[ply] = pvLength[ply + 1];
+
+                    if (alpha >= beta)
+                    {
+                        betaCutoffs++;
+                        if (moveCount == 1)
+                            firstMoveCutoffs++;
+                        if (quiet)
+                            updateQuietStats(ss, move, depth, quietsTried, quietCount);
+                        break;
+                    }
+                }
+            }
+
+            if (quiet && quietCount < 64)
+                quietsTried[quietCount++] = move;
+        }
+
+        if (moveCount == 0)
+            return !excludedMove.isNone() ? alpha : inCheck ? -VALUE_MATE + ply : VALUE_DRAW;
+
+        if (pvNode)
+            bestScore = std::min(bestScore, maxScore);
+
+        if (excludedMove.isNone())
+        {
+            Bound bound = bestScore >= beta ? BoundLower
+                : bestScore > originalAlpha ? BoundExact : BoundUpper;
+            TT.store(key, bound == BoundUpper ? 0 : packMove(bestMove), valueToTT(bestScore, ply), depth, bound);
+        }
+
+        // Fail-soft: trả về điểm tốt nhất thực sự, có thể nằm ngoài [alpha, beta]
+        return bestScore;
+    }
+
+    // Điểm history của nước yên lặng: butterfly + continuation 1 và 2 ply trước
+    int Searcher::quietHistory(const SearchStack *ss, Move move) const
+    {
+        ui piece = board.piecesList[move.from()];
+        int score = histories->butterfly.table[board.st->activeColor][move.from()][move.to()];
+        for (const SearchStack *back : { ss - 1, ss - 2 })
+            if (back->contHist)
+                score += back->contHist->table[piece][move.to()];
+        return score;
+    }
+
+    // Chỉ xét nước ăn quân/phong Hậu cho tới khi thế cờ "yên", tránh hiệu ứng
+    // chân trời. Khi bị chiếu thì xét mọi nước thoát chiếu (không được stand pat).
+    int Searcher::qsearch(int alpha, int beta, int ply)
+    {
+        pvLength[ply] = ply;
+
+        qnodes++;
+        if ((++nodes & (TIME_CHECK_NODES - 1)) == 0)
+            checkLimits();
+        if (stopped())
+            return 0;
+
+        if (isDraw(ply))
+            return VALUE_DRAW;
+        if (alpha < VALUE_DRAW && board.hasUpcomingRepetition(ply))
+        {
+            alpha = VALUE_DRAW;
+            if (alpha >= beta)
+                return alpha;
+        }
+        if (ply >= MAX_SEARCH_PLY - 1 || board.ply >= MAX_PLY - 1)
+            return evaluate(board, *pawns);
+
+        bool pvNode = beta - alpha > 1;
+        u64 key = board.st->zobristKey;
+
+        TTData ttData;
+        bool ttHit = TT.probe(key, ttData);
+        int ttScore = ttHit ? valueFromTT(ttData.score, ply) : 0;
+        if (ttHit && !pvNode && ttData.depth >= DEPTH_QS)
+        {
+            if (ttData.bound == BoundExact
+                || (ttData.bound == BoundLower && ttScore >= beta)
+                || (ttData.bound == BoundUpper && ttScore <= alpha))
+                return ttScore;
+        }
+
+        bool inCheck = board.inCheck();
+        int originalAlpha = alpha;
+        int bestScore = -VALUE_INFINITE;
+        int standPat = -VALUE_INFINITE;
+        if (!inCheck)
+        {
+            standPat = bestScore = evaluate(board, *pawns);
+            // Điểm TT cùng hướng bound là ước lượng tốt hơn eval tĩnh
+            if (ttHit && (ttData.bound & (ttScore > standPat ? BoundLower : BoundUpper)))
+                bestScore = ttScore;
+
+            if (bestScore >= beta)
+            {
+                if (!ttHit)
+                    TT.store(key, 0, valueToTT(bestScore, ply), DEPTH_QS, BoundLower);
+                return bestScore;
+            }
+            alpha = std::max(alpha, bestScore);
+        }
+
+        SearchStack *ss = &stack[ply + 2];
+        const PieceToHistory *continuation[2] = { (ss - 1)->contHist, (ss - 2)->contHist };
+        MovePicker picker(board, ttHit ? Move::fromRaw(ttData.move) : Move(), &histories->butterfly, continuation);
+
+        Move bestMove;
+        int moveCount = 0;
+        for (Move move = picker.next(); !move.isNone(); move = picker.next())
+        {
+            moveCount++;
+            if (!inCheck && bestScore > -VALUE_MATE_IN_MAX_PLY)
+            {
+                // Delta pruning: ăn được cả quân cộng biên vẫn không tới alpha
+                if (!move.isPromotion() && standPat + captureGain(board, move) + DELTA_MARGIN <= alpha)
+                {
+                    bestScore = std::max(bestScore, standPat + captureGain(board, move) + DELTA_MARGIN);
+                    continue;
+                }
+                // Trao đổi thua vật chất
+                if (!seeGe(board, move, 0))
+                    continue;
+            }
+
+            ss->move = move;
+            ss->movedPiece = board.piecesList[move.from()];
+            ss->contHist = &histories->continuation.table[ss->movedPiece][move.to()];
+            board.doMove(move);
+            int score = -qsearch(-beta, -alpha, ply + 1);
+            board.undoMove(move);
+
+            if (stopped())
+                return 0;
+
+            if (score > bestScore)
+            {
+                bestScore = score;
+                if (score > alpha)
+                {
+                    bestMove = move;
+                    alpha = score;
+                    if (alpha >= beta)
+                        break;
+                }
+            }
+        }
+
+        // Bị chiếu mà không còn nước thoát: chiếu hết
+        if (inCheck && moveCount == 0)
+            return -VALUE_MATE + ply;
+
+        Bound bound = bestScore >= beta ? BoundLower
+            : pvNode && bestScore > originalAlpha ? BoundExact : BoundUpper;
+        TT.store(key, packMove(bestMove), valueToTT(bestScore, ply), DEPTH_QS, bound);
+        return bestScore;
+    }
+
+    // Nước yên tĩnh gây cắt beta: thưởng history, phạt các quiet đã thử trước nó
+    void Searcher::updateQuietStats(SearchStack *ss, Move move, int depth, const Move *quiets, int quietCount)
+    {
+        if (!(ss->killers[0] == move))
+        {
+            ss->killers[1] = ss->killers[0];
+            ss->killers[0] = move;
+        }
+
+        SearchStack *previous = ss - 1;
+        if (!previous->move.isNone())
+            histories->counterMoves.table[previous->movedPiece][previous->move.to()] = move;
+
+        ui us = board.st->activeColor;
+        int bonus = std::min(32 * depth * depth, 1600);
+        auto update = [&](Move m, int value)
+        {
+            ui piece = board.piecesList[m.from()];
+            updateHistory(histories->butterfly.table[us][m.from()][m.to()], value);
+            for (SearchStack *back : { ss - 1, ss - 2 })
+                if (back->contHist)
+                    updateHistory(back->contHist->table[piece][m.to()], value);
+        };
+
+        update(move, bonus);
+        for (int i = 0; i < quietCount; i++)
+            update(quiets[i], -bonus);
+    }
+
+    std::string scoreToString(int score)
+    {
+        if (score >= VALUE_MATE_IN_MAX_PLY)
+            return "mate " + std::to_string((VALUE_MATE - score + 1) / 2);
+        if (score <= -VALUE_MATE_IN_MAX_PLY)
+            return "mate " + std::to_string(-(VALUE_MATE + score) / 2);
+        return "cp " + std::to_string(score);
+    }
+
+    void printSearchInfo(const SearchInfo &info, std::ostream &out)
+    {
+        u64 nps = info.timeMs > 0 ? info.nodes * 1000 / info.timeMs : info.nodes;
+        out << "info depth " << info.depth << " score " << scoreToString(info.score)
+            << " nodes " << info.nodes << " nps " << nps << " hashfull " << info.hashfull
+            << " tbhits " << info.tbHits
+            << " time " << info.timeMs << " pv";
+        for (const Move &move : info.pv)
+            out << ' ' << moveToString(move);
+        out << std::endl;
+    }
+
+    SearchInfo SearchPool::think(const Board &board, const SearchLimits &limits,
+        std::function<void(const SearchInfo &)> onIteration)
+    {
+        shared.nodes = 0;
+        shared.ponder = limits.ponder;
+        TT.newSearch();
+
+        while ((int)pawnTables.size() < threads)
+            pawnTables.push_back(std::make_unique<PawnTable>());
+
+        std::vector<std::unique_ptr<Searcher>> searchers;
+        for (int id = 0; id < threads; id++)
+            searchers.push_back(std::make_unique<Searcher>(board, &shared, id, pawnTables[id].get()));
+        searchers[0]->onIteration = onIteration;
+
+        std::vector<SearchInfo> results(threads);
+        std::vector<std::thread> helpers;
+        for (int id = 1; id < threads; id++)
+            helpers.emplace_back([&, id] { results[id] = searchers[id]->think(limits); });
+
+        results[0] = searchers[0]->think(limits);
+
+        // Luồng chính xong (hết độ sâu/thời gian) thì dừng mọi luồng phụ
+        shared.stop = true;
+        for (std::thread &helper : helpers)
+            helper.join();
+        shared.stop = false;
+
+        // Bỏ phiếu: mỗi luồng bầu cho nước tốt nhất của nó, trọng số tăng theo
+        // điểm và độ sâu đã hoàn tất
+        int minScore = VALUE_INFINITE;
+        for (const SearchInfo &info : results)
+            if (info.depth > 0)
+                minScore = std::min(minScore, info.score);
+
+        std::map<uint16_t, long long> votes;
+        int best = 0;
+        for (int id = 0; id < threads; id++)
+        {
+            const SearchInfo &info = results[id];
+            if (info.depth == 0)
+                continue;
+            long long &vote = votes[packMove(info.bestMove)];
+            vote += (long long)(info.score - minScore + 14) * info.depth;
+
+            const SearchInfo &current = results[best];
+            if (current.depth == 0
+                || (std::abs(info.score) >= VALUE_MATE_IN_MAX_PLY && info.score > current.score)
+                || (vote > votes[packMove(current.bestMove)] && std::abs(current.score) < VALUE_MATE_IN_MAX_PLY))
+                best = id;
+        }
+
+        SearchInfo result = results[best];
+        result.nodes = result.qnodes = result.tbHits = result.betaCutoffs = result.firstMoveCutoffs = 0;
+        for (const SearchInfo &info : results)
+        {
+            result.nodes += info.nodes;
+            result.qnodes += info.qnodes;
+            result.tbHits += info.tbHits;
+            result.betaCutoffs += info.betaCutoffs;
+            result.firstMoveCutoffs += info.firstMoveCutoffs;
+        }
+        return result;
+    }
+
+    void SearchPool::clear()
+    {
+        for (auto &table : pawnTables)
+            table->clear();
+    }
+
+    double SearchPool::pawnHitRate() const
+    {
+        u64 probes = 0, hits = 0;
+        for (const auto &table : pawnTables)
+        {
+            probes += table->probes();
+            hits += table->hits();
+        }
+        return probes ? (double)hits / probes : 0.0;
+    }
+
+    const std::vector<std::string> &benchPositions()
+    {
+        static const std::vector<std::string> positions = {
+            "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+            "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+            "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+            "r1bqk2r/ppp1bppp/2np1n2/1B2p3/3PP3/2N2N2/PPP2PPP/R1BQK2R w KQkq - 2 6",
+            "3RK1k1/r3P1p1/7p/5r2/5P2/8/8/8 w - - 9 56",
+            "r2r1k2/ppR2Qp1/1q2pp1p/3p4/8/3P4/PP3PPP/2R3K1 b - - 1 24",
+        };
+        return positions;
+    }
+
+    void runBench(int depth, int threads, std::ostream &out)
+    {
+        SearchPool pool;
+        pool.setThreads(threads);
+
+        u64 totalNodes = 0, totalQNodes = 0;
+        u64 cutoffs = 0, firstMoveCutoffs = 0;
+        int totalMs = 0;
+        for (const std::string &fen : benchPositions())
+        {
+            Board board{ Fen(fen) };
+            TT.clear();
+            SearchLimits limits;
+            limits.depth = depth;
+            SearchInfo info = pool.think(board, limits);
+
+            totalNodes += info.nodes;
+            totalQNodes += info.qnodes;
+            totalMs += info.timeMs;
+            cutoffs += info.betaCutoffs;
+            firstMoveCutoffs += info.firstMoveCutoffs;
+            out << std::left << std::setw(72) << fen << std::right
+                << " depth " << info.depth << "  " << std::setw(10) << scoreToString(info.score)
+                << "  best " << moveToString(info.bestMove)
+                << "  nodes " << info.nodes << "  time " << info.timeMs << "ms\n";
+        }
+
+        u64 nps = totalMs > 0 ? totalNodes * 1000 / totalMs : totalNodes;
+        out << "\nTotal time: " << totalMs << "ms  Nodes: " << totalNodes << "  NPS: " << nps
+            << "  QNodes: " << std::fixed << std::setprecision(1)
+            << (totalNodes ? 100.0 * totalQNodes / totalNodes : 0.0) << "%"
+            << "  Pawn hash hits: " << std::fixed << std::setprecision(1) << pool.pawnHitRate() * 100 << "%"
+            << "  First-move cutoffs: " << (cutoffs ? 100.0 * firstMoveCutoffs / cutoffs : 0.0) << "%\n";
+        out.unsetf(std::ios::fixed);
+    }
+
+    void runFeatureBench(int depth, std::ostream &out)
+    {
+        out << "Time to depth " << depth << " on " << benchPositions().size() << " positions\n";
+
+        auto run = [&](const char *label, const SearchFeatures &features)
+        {
+            SearchPool pool;
+            u64 totalNodes = 0;
+            int totalMs = 0;
+            for (const std::string &fen : benchPositions())
+            {
+                Board board{ Fen(fen) };
+                TT.clear();
+                SearchLimits limits;
+                limits.depth = depth;
+                limits.features = features;
+                SearchInfo info = pool.think(board, limits);
+                totalNodes += info.nodes;
+                totalMs += info.timeMs;
+            }
+            out << std::left << std::setw(22) << label << std::right
+                << "  nodes " << std::setw(11) << totalNodes << "  time " << std::setw(7) << totalMs << "ms\n";
+        };
+
+        run("all enabled", SearchFeatures());
+        for (const SearchFeatureOption &option : searchFeatureOptions())
+        {
+            SearchFeatures features;
+            features.*option.flag = false;
+            run((std::string("no ") + option.name).c_str(), features);
+        }
+        run("all disabled", [] {
+            SearchFeatures features;
+            for (const SearchFeatureOption &option : searchFeatureOptions())
+                features.*option.flag = false;
+            return features;
+        }());
+    }
+
+    void runSmpBench(int depth, int maxThreads, std::ostream &out)
+    {
+        out << "Time to depth " << depth << " on " << benchPositions().size() << " positions\n";
+
+        int baselineMs = 0;
+        for (int threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            SearchPool pool;
+            pool.setThreads(threads);
+
+            u64 totalNodes = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (const std::string &fen : benchPositions())
+            {
+                Board board{ Fen(fen) };
+                TT.clear();
+                SearchLimits limits;
+                limits.depth = depth;
+                totalNodes += pool.think(board, limits).nodes;
+            }
+            int ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            if (threads == 1)
+                baselineMs = std::max(ms, 1);
+
+            out << "threads " << std::setw(2) << threads << "  time " << std::setw(7) << ms << "ms"
+                << "  nodes " << std::setw(11) << totalNodes
+                << "  speedup " << std::fixed << std::setprecision(2) << (double)baselineMs / std::max(ms, 1) << "x\n";
+            out.unsetf(std::ios::fixed);
+        }
+    }
+}
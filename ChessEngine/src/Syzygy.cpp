@@ -0,0 +1,1260 @@
+#include "Syzygy.h"
+#include "MoveGenerator.h"
+#include "Evaluator.h"
+#include "Search.h"
+#include "MappedFile.h"
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace ChessEngine::Syzygy
+{
+    namespace
+    {
+        constexpr int MAX_DTZ = 1 << 18;
+
+        // ===== Bảng đánh chỉ số, tính lúc biên dịch như AttackTable =====
+
+        // Đường chéo a1-h8: < 0 phía dưới, 0 trên đường chéo, > 0 phía trên
+        constexpr int offA1H8(int square) { return (square >> 3) - (square & 7); }
+        constexpr int flipFile(int square) { return square ^ 7; }
+
+        struct IndexTables
+        {
+            int mapPawns[64];       // ô tốt -> chỉ số (tốt dẫn đầu trên cột a..d)
+            int mapB1H1H7[64];      // 28 ô dưới đường chéo
+            int mapA1D1D4[64];      // tam giác a1-d1-d4 (10 ô) cho quân đầu tiên
+            int mapKK[10][64];      // cặp vua không kề nhau, đã chuẩn hóa đối xứng: 462
+            int binomial[6][64];    // C(n, k)
+            int leadPawnIdx[6][64]; // [số tốt dẫn][ô tốt dẫn]
+            int leadPawnsSize[6][4];
+
+            constexpr IndexTables()
+                : mapPawns{}, mapB1H1H7{}, mapA1D1D4{}, mapKK{}, binomial{}, leadPawnIdx{}, leadPawnsSize{}
+            {
+                int code = 0;
+                for (int s = 0; s < 64; s++)
+                    if (offA1H8(s) < 0)
+                        mapB1H1H7[s] = code++;
+
+                // Ô trên đường chéo a1-d4 được đánh số sau cùng
+                int diagonal[4] = {}, diagonalCount = 0;
+                code = 0;
+                for (int s = 0; s <= 27; s++)
+                {
+                    if (offA1H8(s) < 0 && (s & 7) <= 3)
+                        mapA1D1D4[s] = code++;
+                    else if (!offA1H8(s) && (s & 7) <= 3)
+                        diagonal[diagonalCount++] = s;
+                }
+                for (int i = 0; i < diagonalCount; i++)
+                    mapA1D1D4[diagonal[i]] = code++;
+
+                // Vua thứ nhất trong tam giác a1-d1-d4; nếu nó nằm trên đường
+                // chéo thì vua thứ hai ở phía dưới đường chéo, cặp cùng nằm trên
+                // đường chéo đánh số sau cùng
+                int bothIdx[64] = {}, bothSquare[64] = {}, bothCount = 0;
+                code = 0;
+                for (int idx = 0; idx < 10; idx++)
+                    for (int s1 = 0; s1 <= 27; s1++)
+                        if (mapA1D1D4[s1] == idx && (idx || s1 == 1))
+                            for (int s2 = 0; s2 < 64; s2++)
+                            {
+                                int rankDistance = (s1 >> 3) - (s2 >> 3), fileDistance = (s1 & 7) - (s2 & 7);
+                                if (rankDistance >= -1 && rankDistance <= 1 && fileDistance >= -1 && fileDistance <= 1)
+                                    continue; // trùng ô hoặc hai vua kề nhau
+                                if (!offA1H8(s1) && offA1H8(s2) > 0)
+                                    continue;
+                                if (!offA1H8(s1) && !offA1H8(s2))
+                                {
+                                    bothIdx[bothCount] = idx;
+                                    bothSquare[bothCount++] = s2;
+                                }
+                                else
+                                    mapKK[idx][s2] = code++;
+                            }
+                for (int i = 0; i < bothCount; i++)
+                    mapKK[bothIdx[i]][bothSquare[i]] = code++;
+
+                binomial[0][0] = 1;
+                for (int n = 1; n < 64; n++)
+                    for (int k = 0; k < 6 && k <= n; k++)
+                        binomial[k][n] = (k > 0 ? binomial[k - 1][n - 1] : 0) + (k < n ? binomial[k][n - 1] : 0);
+
+                // mapPawns đánh số xen kẽ cột f và cột đối xứng 7 - f, từ hàng 2 lên
+                int available = 47;
+                for (int leadPawns = 1; leadPawns <= 5; leadPawns++)
+                    for (int file = 0; file < 4; file++)
+                    {
+                        int idx = 0;
+                        for (int rank = 1; rank <= 6; rank++)
+                        {
+                            int square = rank * 8 + file;
+                            if (leadPawns == 1)
+                            {
+                                mapPawns[square] = available--;
+                                mapPawns[flipFile(square)] = available--;
+                            }
+                            leadPawnIdx[leadPawns][square] = idx;
+                            idx += binomial[leadPawns - 1][mapPawns[square]];
+                        }
+                        leadPawnsSize[leadPawns][file] = idx;
+                    }
+            }
+        };
+
+        constexpr IndexTables indexTables;
+        static_assert(indexTables.mapKK[9][63] == 461, "king pair encoding must cover 462 positions");
+
+        bool pawnsBefore(int a, int b) { return indexTables.mapPawns[a] < indexTables.mapPawns[b]; }
+
+        // ===== Đọc số trong file (little/big endian, không căn lề) =====
+
+        uint16_t readLE16(const uint8_t *p) { return uint16_t(p[0] | p[1] << 8); }
+        uint32_t readLE32(const uint8_t *p) { return p[0] | p[1] << 8 | p[2] << 16 | uint32_t(p[3]) << 24; }
+        uint32_t readBE32(const uint8_t *p) { return uint32_t(p[0]) << 24 | p[1] << 16 | p[2] << 8 | p[3]; }
+        u64 readBE64(const uint8_t *p) { return u64(readBE32(p)) << 32 | readBE32(p + 4); }
+
+        // ===== Dữ liệu nén (Huffman chuẩn + cặp ký hiệu) =====
+
+        using Sym = uint16_t;
+
+        // Nút cây ký hiệu: hai ký hiệu con 12 bit gói trong 3 byte
+        struct LR
+        {
+            uint8_t lr[3];
+            Sym left() const { return Sym(((lr[1] & 0xF) << 8) | lr[0]); }
+            Sym right() const { return Sym((lr[2] << 4) | (lr[1] >> 4)); }
+        };
+
+        // Mục chỉ mục thưa: số block (LE32) và vị trí trong block (LE16)
+        struct SparseEntry
+        {
+            uint8_t block[4];
+            uint8_t offset[2];
+        };
+
+        static_assert(sizeof(LR) == 3 && sizeof(SparseEntry) == 6, "tablebase records must be packed");
+
+        enum TableFlag : uint8_t
+        {
+            FlagSTM = 1,
+            FlagMapped = 2,
+            FlagWinPlies = 4,
+            FlagLossPlies = 8,
+            FlagWide = 16,
+            FlagSingleValue = 128
+        };
+
+        // Một bảng con (theo bên đi và cột tốt dẫn đầu)
+        struct PairsData
+        {
+            uint8_t flags = 0;
+            u64 sizeofBlock = 0;
+            u64 span = 0; // số chỉ số trên mỗi mục chỉ mục thưa
+            u64 numBlocks = 0;
+            int maxSymLen = 0;
+            int minSymLen = 0;
+            const uint8_t *lowestSym = nullptr;   // Sym LE theo độ dài mã
+            const LR *btree = nullptr;
+            const uint8_t *blockLength = nullptr; // uint16 LE, số giá trị - 1 mỗi block
+            u64 blockLengthSize = 0;
+            const SparseEntry *sparseIndex = nullptr;
+            u64 sparseIndexSize = 0;
+            const uint8_t *data = nullptr;
+            std::vector<u64> base64; // mã nhỏ nhất theo độ dài, căn trái 64 bit
+            std::vector<uint8_t> symlen; // số giá trị mà mỗi ký hiệu mở rộng ra, trừ 1
+            int pieces[MAX_PIECES] = {}; // mã quân theo thứ tự đánh chỉ số
+            u64 groupIdx[MAX_PIECES + 1] = {};
+            int groupLen[MAX_PIECES + 1] = {}; // kết thúc bằng 0
+            uint16_t mapIdx[4] = {}; // DTZ: vị trí bảng ánh xạ theo WDL
+        };
+
+        // ===== Map file chỉ đọc =====
+
+        // Map file và kiểm tra kích thước (luôn 64k + 16 byte) cùng magic;
+        // trả về phần dữ liệu sau magic
+        const uint8_t *mapFile(const std::string &path, MappedFile &file, bool dtz)
+        {
+            if (!file.open(path))
+                return nullptr;
+
+            constexpr uint8_t WdlMagic[] = { 0x71, 0xE8, 0x23, 0x5D };
+            constexpr uint8_t DtzMagic[] = { 0xD7, 0x66, 0x0C, 0xA5 };
+            if (file.size() % 64 != 16 || std::memcmp(file.data(), dtz ? DtzMagic : WdlMagic, 4))
+            {
+                file.close();
+                return nullptr;
+            }
+            return file.data() + 4;
+        }
+
+        // ===== Bảng =====
+
+        // Một file .rtbw hoặc .rtbz. Chỉ được map (và giải mã phần đầu) khi lần
+        // đầu cần tới; sau đó chỉ đọc nên các luồng dùng chung không cần khóa.
+        struct Table
+        {
+            std::string name; // "KQvKR", bên mạnh hơn (khóa key) đứng trước
+            bool isDtz = false;
+            u64 key = 0;  // khóa vật chất khi bên mạnh là Trắng
+            u64 key2 = 0; // khóa khi đổi màu
+            int pieceCount = 0;
+            bool hasPawns = false;
+            bool hasUniquePieces = false;
+            uint8_t pawnCount[2] = {}; // [bên có tốt dẫn đầu, bên kia]
+
+            std::atomic<bool> ready{ false };
+            MappedFile file;
+            const uint8_t *map = nullptr; // DTZ: bảng ánh xạ giá trị
+            PairsData items[2][4];        // [bên đi][cột tốt dẫn]; DTZ chỉ có một bên
+
+            PairsData *get(int stm, int file) { return &items[isDtz ? 0 : stm][hasPawns ? file : 0]; }
+        };
+
+        struct Registry
+        {
+            std::vector<std::string> directories;
+            std::vector<std::unique_ptr<Table>> tables;
+            std::unordered_map<u64, std::pair<Table *, Table *>> byKey; // (WDL, DTZ)
+            int maxPieces = 0;
+        };
+        Registry registry;
+        std::mutex mappingMutex;
+
+        // Khóa vật chất: số quân mỗi loại (trừ vua) gói 4 bit, bên "0" ở nửa thấp
+        u64 materialKey(const Board &board, bool mirror)
+        {
+            u64 key = 0;
+            for (ui color : { White, Black })
+                for (ui type = Pawn; type < King; type++)
+                {
+                    int side = (color == White) != mirror ? 0 : 1;
+                    key += u64(std::popcount(board.pieces[makePiece(color, type)])) << (4 * (type + 5 * side));
+                }
+            return key;
+        }
+
+        u64 materialKey(const std::string &name, bool mirror)
+        {
+            constexpr const char *Types = "PNBRQ";
+            u64 key = 0;
+            int side = mirror;
+            for (char c : name)
+            {
+                if (c == 'v')
+                    side ^= 1;
+                else if (c != 'K')
+                    key += u64(1) << (4 * ((std::strchr(Types, c) - Types) + 5 * side));
+            }
+            return key;
+        }
+
+        std::unique_ptr<Table> makeTable(const std::string &name, bool dtz)
+        {
+            auto table = std::make_unique<Table>();
+            table->name = name;
+            table->isDtz = dtz;
+            table->key = materialKey(name, false);
+            table->key2 = materialKey(name, true);
+
+            int counts[2][6] = {};
+            int side = 0;
+            for (char c : name)
+            {
+                if (c == 'v')
+                {
+                    side = 1;
+                    continue;
+                }
+                counts[side][std::strchr("PNBRQK", c) - "PNBRQK"]++;
+                table->pieceCount++;
+            }
+            table->hasPawns = counts[0][Pawn] + counts[1][Pawn] > 0;
+            for (int s = 0; s < 2; s++)
+                for (ui type = Pawn; type < King; type++)
+                    table->hasUniquePieces |= counts[s][type] == 1;
+
+            // Tốt dẫn đầu thuộc bên có ít tốt hơn (nhưng > 0), ưu tiên bên mạnh
+            int whitePawns = counts[0][Pawn], blackPawns = counts[1][Pawn];
+            bool whiteLeads = !blackPawns || (whitePawns && blackPawns >= whitePawns);
+            table->pawnCount[0] = uint8_t(whiteLeads ? whitePawns : blackPawns);
+            table->pawnCount[1] = uint8_t(whiteLeads ? blackPawns : whitePawns);
+            return table;
+        }
+
+        bool fileExists(const std::string &name)
+        {
+            for (const std::string &directory : registry.directories)
+                if (std::ifstream(directory + "/" + name).good())
+                    return true;
+            return false;
+        }
+
+        // types: các loại quân theo thứ tự trong tên file, hai vua ngăn hai bên
+        void addTable(std::initializer_list<int> types)
+        {
+            std::string name;
+            for (int type : types)
+                name += "PNBRQK"[type];
+            name.insert(name.find('K', 1), "v");
+
+            if (!fileExists(name + ".rtbw"))
+                return;
+
+            registry.maxPieces = std::max(registry.maxPieces, int(types.size()));
+            registry.tables.push_back(makeTable(name, false));
+            Table *wdl = registry.tables.back().get();
+            registry.tables.push_back(makeTable(name, true));
+            Table *dtz = registry.tables.back().get();
+            registry.byKey[wdl->key] = { wdl, dtz };
+            registry.byKey[wdl->key2] = { wdl, dtz };
+        }
+
+        // ===== Giải mã phần đầu file =====
+
+        // Chia quân thành nhóm (các quân giống nhau liên tiếp) và tính hệ số
+        // của từng nhóm trong chỉ số theo thứ tự order của file
+        void setGroups(Table &table, PairsData *d, const int order[], int file)
+        {
+            int n = 0;
+            int firstLen = table.hasPawns ? 0 : table.hasUniquePieces ? 3 : 2;
+            d->groupLen[n] = 1;
+
+            for (int i = 1; i < table.pieceCount; i++)
+                if (--firstLen > 0 || d->pieces[i] == d->pieces[i - 1])
+                    d->groupLen[n]++;
+                else
+                    d->groupLen[++n] = 1;
+            d->groupLen[++n] = 0;
+
+            bool pawnsOnBothSides = table.hasPawns && table.pawnCount[1];
+            int next = pawnsOnBothSides ? 2 : 1;
+            int freeSquares = 64 - d->groupLen[0] - (pawnsOnBothSides ? d->groupLen[1] : 0);
+            u64 idx = 1;
+
+            for (int k = 0; next < n || k == order[0] || k == order[1]; k++)
+            {
+                if (k == order[0])
+                {
+                    d->groupIdx[0] = idx;
+                    idx *= table.hasPawns ? indexTables.leadPawnsSize[d->groupLen[0]][file]
+                        : table.hasUniquePieces ? 31332 : 462;
+                }
+                else if (k == order[1])
+                {
+                    d->groupIdx[1] = idx;
+                    idx *= indexTables.binomial[d->groupLen[1]][48 - d->groupLen[0]];
+                }
+                else
+                {
+                    d->groupIdx[next] = idx;
+                    idx *= indexTables.binomial[d->groupLen[next]][freeSquares];
+                    freeSquares -= d->groupLen[next++];
+                }
+            }
+            d->groupIdx[n] = idx;
+        }
+
+        // Số giá trị mà ký hiệu s mở rộng ra (trừ 1), đệ quy theo cây cặp
+        uint8_t setSymlen(PairsData *d, Sym s, std::vector<bool> &visited)
+        {
+            visited[s] = true;
+            Sym right = d->btree[s].right();
+            if (right == 0xFFF)
+                return 0;
+            Sym left = d->btree[s].left();
+            if (!visited[left])
+                d->symlen[left] = setSymlen(d, left, visited);
+            if (!visited[right])
+                d->symlen[right] = setSymlen(d, right, visited);
+            return uint8_t(d->symlen[left] + d->symlen[right] + 1);
+        }
+
+        const uint8_t *setSizes(PairsData *d, const uint8_t *data)
+        {
+            d->flags = *data++;
+            if (d->flags & FlagSingleValue)
+            {
+                d->numBlocks = d->span = d->blockLengthSize = d->sparseIndexSize = 0;
+                d->minSymLen = *data++; // giá trị duy nhất
+                return data;
+            }
+
+            u64 tableSize = d->groupIdx[std::find(d->groupLen, d->groupLen + MAX_PIECES + 1, 0) - d->groupLen];
+            d->sizeofBlock = u64(1) << *data++;
+            d->span = u64(1) << *data++;
+            d->sparseIndexSize = (tableSize + d->span - 1) / d->span;
+            int padding = *data++;
+            d->numBlocks = readLE32(data);
+            data += 4;
+            d->blockLengthSize = d->numBlocks + padding;
+            d->maxSymLen = *data++;
+            d->minSymLen = *data++;
+            d->lowestSym = data;
+            d->base64.resize(d->maxSymLen - d->minSymLen + 1);
+
+            // Mã Huffman chuẩn: base64[i] là mã nhỏ nhất có độ dài minSymLen + i
+            for (int i = int(d->base64.size()) - 2; i >= 0; i--)
+                d->base64[i] = (d->base64[i + 1] + readLE16(d->lowestSym + 2 * i)
+                    - readLE16(d->lowestSym + 2 * (i + 1))) / 2;
+            for (size_t i = 0; i < d->base64.size(); i++)
+                d->base64[i] <<= 64 - i - d->minSymLen;
+
+            data += d->base64.size() * sizeof(Sym);
+            d->symlen.resize(readLE16(data));
+            data += 2;
+            d->btree = reinterpret_cast<const LR *>(data);
+
+            std::vector<bool> visited(d->symlen.size());
+            for (Sym sym = 0; sym < d->symlen.size(); sym++)
+                if (!visited[sym])
+                    d->symlen[sym] = setSymlen(d, sym, visited);
+
+            return data + d->symlen.size() * sizeof(LR) + (d->symlen.size() & 1);
+        }
+
+        const uint8_t *setDtzMap(Table &table, const uint8_t *data, int maxFile)
+        {
+            table.map = data;
+            for (int file = 0; file <= maxFile; file++)
+            {
+                PairsData *d = table.get(0, file);
+                if (!(d->flags & FlagMapped))
+                    continue;
+                if (d->flags & FlagWide)
+                {
+                    data += uintptr_t(data) & 1; // căn lề 2 byte
+                    for (int i = 0; i < 4; i++)
+                    {
+                        d->mapIdx[i] = uint16_t((data - table.map) / 2 + 1);
+                        data += 2 * readLE16(data) + 2;
+                    }
+                }
+                else
+                {
+                    for (int i = 0; i < 4; i++)
+                    {
+                        d->mapIdx[i] = uint16_t(data - table.map + 1);
+                        data += *data + 1;
+                    }
+                }
+            }
+            return data + (uintptr_t(data) & 1);
+        }
+
+        void setupTable(Table &table, const uint8_t *data)
+        {
+            data++; // cờ chung của file, đã suy ra từ tên bảng
+
+            int sides = !table.isDtz && table.key != table.key2 ? 2 : 1;
+            int maxFile = table.hasPawns ? 3 : 0;
+            bool pawnsOnBothSides = table.hasPawns && table.pawnCount[1];
+
+            for (int file = 0; file <= maxFile; file++)
+            {
+                for (int i = 0; i < sides; i++)
+                    *table.get(i, file) = PairsData();
+
+                int order[2][2] = { { data[0] & 0xF, pawnsOnBothSides ? data[1] & 0xF : 0xF },
+                                    { data[0] >> 4, pawnsOnBothSides ? data[1] >> 4 : 0xF } };
+                data += 1 + pawnsOnBothSides;
+
+                for (int k = 0; k < table.pieceCount; k++, data++)
+                    for (int i = 0; i < sides; i++)
+                        table.get(i, file)->pieces[k] = i ? data[0] >> 4 : data[0] & 0xF;
+
+                for (int i = 0; i < sides; i++)
+                    setGroups(table, table.get(i, file), order[i], file);
+            }
+
+            data += uintptr_t(data) & 1;
+
+            for (int file = 0; file <= maxFile; file++)
+                for (int i = 0; i < sides; i++)
+                    data = setSizes(table.get(i, file), data);
+
+            if (table.isDtz)
+                data = setDtzMap(table, data, maxFile);
+
+            for (int file = 0; file <= maxFile; file++)
+                for (int i = 0; i < sides; i++)
+                {
+                    PairsData *d = table.get(i, file);
+                    d->sparseIndex = reinterpret_cast<const SparseEntry *>(data);
+                    data += d->sparseIndexSize * sizeof(SparseEntry);
+                }
+
+            for (int file = 0; file <= maxFile; file++)
+                for (int i = 0; i < sides; i++)
+                {
+                    PairsData *d = table.get(i, file);
+                    d->blockLength = data;
+                    data += d->blockLengthSize * sizeof(uint16_t);
+                }
+
+            for (int file = 0; file <= maxFile; file++)
+                for (int i = 0; i < sides; i++)
+                {
+                    data = reinterpret_cast<const uint8_t *>((uintptr_t(data) + 0x3F) & ~uintptr_t(0x3F)); // căn 64 byte
+                    PairsData *d = table.get(i, file);
+                    d->data = data;
+                    data += d->numBlocks * d->sizeofBlock;
+                }
+        }
+
+        // Map file khi lần đầu cần tới. Khóa chỉ giữ trong lần đó; về sau
+        // ready (acquire) đảm bảo luồng khác thấy dữ liệu đã giải mã.
+        bool mapped(Table &table)
+        {
+            if (table.ready.load(std::memory_order_acquire))
+                return table.file.isOpen();
+
+            std::lock_guard<std::mutex> lock(mappingMutex);
+            if (table.ready.load(std::memory_order_relaxed))
+                return table.file.isOpen();
+
+            std::string fileName = table.name + (table.isDtz ? ".rtbz" : ".rtbw");
+            for (const std::string &directory : registry.directories)
+            {
+                const uint8_t *data = mapFile(directory + "/" + fileName, table.file, table.isDtz);
+                if (data)
+                {
+                    setupTable(table, data);
+                    break;
+                }
+            }
+            table.ready.store(true, std::memory_order_release);
+            return table.file.isOpen();
+        }
+
+        // ===== Tra bảng =====
+
+        // Giá trị thứ idx của bảng con: tìm block qua chỉ mục thưa, rồi giải mã
+        // Huffman từng ký hiệu tới khi gặp ký hiệu chứa idx
+        int decompressPairs(PairsData *d, u64 idx)
+        {
+            if (d->flags & FlagSingleValue)
+                return d->minSymLen;
+
+            uint32_t k = uint32_t(idx / d->span);
+            uint32_t block = readLE32(d->sparseIndex[k].block);
+            int offset = readLE16(d->sparseIndex[k].offset);
+
+            // Mục chỉ mục thưa trỏ vào giữa đoạn span của nó
+            offset += int(idx % d->span) - int(d->span / 2);
+
+            while (offset < 0)
+                offset += readLE16(d->blockLength + 2 * --block) + 1;
+            while (offset > readLE16(d->blockLength + 2 * block))
+                offset -= readLE16(d->blockLength + 2 * block++) + 1;
+
+            const uint8_t *ptr = d->data + u64(block) * d->sizeofBlock;
+            u64 buf64 = readBE64(ptr);
+            ptr += 8;
+            int buf64Size = 64;
+            Sym sym;
+
+            while (true)
+            {
+                int len = 0;
+                while (buf64 < d->base64[len])
+                    len++;
+
+                sym = Sym((buf64 - d->base64[len]) >> (64 - len - d->minSymLen));
+                sym += readLE16(d->lowestSym + 2 * len);
+
+                if (offset < d->symlen[sym] + 1)
+                    break;
+
+                offset -= d->symlen[sym] + 1;
+                len += d->minSymLen;
+                buf64 <<= len;
+                buf64Size -= len;
+
+                if (buf64Size <= 32)
+                {
+                    buf64Size += 32;
+                    buf64 |= u64(readBE32(ptr)) << (64 - buf64Size);
+                    ptr += 4;
+                }
+            }
+
+            // Ký hiệu là cặp (left, right): đi xuống tới ký hiệu lá chứa offset
+            while (d->symlen[sym])
+            {
+                Sym left = d->btree[sym].left();
+                if (offset < d->symlen[left] + 1)
+                    sym = left;
+                else
+                {
+                    offset -= d->symlen[left] + 1;
+                    sym = d->btree[sym].right();
+                }
+            }
+            return d->btree[sym].left();
+        }
+
+        // Bảng DTZ chỉ lưu một bên đi (trừ bảng đối xứng không tốt)
+        bool checkDtzStm(Table &table, int stm, int file)
+        {
+            int flags = table.get(stm, file)->flags;
+            return (flags & FlagSTM) == stm || (table.key == table.key2 && !table.hasPawns);
+        }
+
+        int mapScore(Table &table, int file, int value, WDLScore wdl)
+        {
+            if (!table.isDtz)
+                return value - 2;
+
+            constexpr int WdlMap[] = { 1, 3, 0, 2, 0 };
+            PairsData *d = table.get(0, file);
+            int flags = d->flags;
+            if (flags & FlagMapped)
+            {
+                int index = d->mapIdx[WdlMap[wdl + 2]] + value;
+                value = flags & FlagWide ? readLE16(table.map + 2 * index) : table.map[index];
+            }
+
+            // Giá trị lưu theo nước đi (2 ply) trừ khi file ghi theo ply
+            if ((wdl == WDLWin && !(flags & FlagWinPlies)) || (wdl == WDLLoss && !(flags & FlagLossPlies))
+                || wdl == WDLCursedWin || wdl == WDLBlessedLoss)
+                value *= 2;
+            return value + 1;
+        }
+
+        // Mã quân trong file: 1..6 = Tốt..Vua Trắng, +8 cho quân Đen
+        int tbPiece(ui piece) { return int(typeOf(piece)) + 1 + (piece >= BlackPawn ? 8 : 0); }
+
+        // Chuẩn hóa thế (đổi màu, lật bàn theo đối xứng) rồi tính chỉ số và tra bảng
+        int probeTable(Board &board, Table &table, WDLScore wdl, ProbeState &state)
+        {
+            int squares[MAX_PIECES];
+            int pieces[MAX_PIECES];
+            int size = 0;
+            int leadPawnsCount = 0;
+            u64 leadPawns = 0;
+            int file = 0;
+
+            // Bảng lưu theo bên mạnh (key) là Trắng; bảng đối xứng chỉ lưu Trắng đi
+            int sideToMove = board.st->activeColor == White ? 0 : 1;
+            bool symmetricBlackToMove = table.key == table.key2 && sideToMove == 1;
+            bool blackStronger = materialKey(board, false) != table.key;
+            bool flip = symmetricBlackToMove || blackStronger;
+            int flipColor = flip ? 8 : 0;
+            int flipSquares = flip ? 56 : 0;
+            int stm = sideToMove ^ flip;
+
+            if (table.hasPawns)
+            {
+                int leadPiece = table.get(0, 0)->pieces[0] ^ flipColor;
+                ui color = leadPiece & 8 ? Black : White;
+                u64 bb = leadPawns = board.pieces[makePiece(color, Pawn)];
+                do
+                    squares[size++] = int(popLsb(bb)) ^ flipSquares;
+                while (bb);
+                leadPawnsCount = size;
+
+                std::swap(squares[0], *std::max_element(squares, squares + leadPawnsCount, pawnsBefore));
+                file = std::min(squares[0] & 7, 7 - (squares[0] & 7));
+            }
+
+            if (table.isDtz && !checkDtzStm(table, stm, file))
+            {
+                state = ProbeChangeSide;
+                return 0;
+            }
+
+            u64 bb = board.occupancy() ^ leadPawns;
+            do
+            {
+                ui square = popLsb(bb);
+                squares[size] = int(square) ^ flipSquares;
+                pieces[size++] = tbPiece(board.piecesList[square]) ^ flipColor;
+            } while (bb);
+
+            PairsData *d = table.get(stm, file);
+
+            // Xếp quân theo thứ tự đánh chỉ số của file
+            for (int i = leadPawnsCount; i < size - 1; i++)
+                for (int j = i + 1; j < size; j++)
+                    if (d->pieces[i] == pieces[j])
+                    {
+                        std::swap(pieces[i], pieces[j]);
+                        std::swap(squares[i], squares[j]);
+                        break;
+                    }
+
+            // Quân đầu tiên luôn về nửa a-d
+            if ((squares[0] & 7) > 3)
+                for (int i = 0; i < size; i++)
+                    squares[i] = flipFile(squares[i]);
+
+            u64 idx;
+            if (table.hasPawns)
+            {
+                idx = indexTables.leadPawnIdx[leadPawnsCount][squares[0]];
+                std::stable_sort(squares + 1, squares + leadPawnsCount, pawnsBefore);
+                for (int i = 1; i < leadPawnsCount; i++)
+                    idx += indexTables.binomial[i][indexTables.mapPawns[squares[i]]];
+            }
+            else
+            {
+                // Không tốt: thêm đối xứng lật hàng và qua đường chéo a1-h8
+                if ((squares[0] >> 3) > 3)
+                    for (int i = 0; i < size; i++)
+                        squares[i] ^= 56;
+
+                for (int i = 0; i < d->groupLen[0]; i++)
+                {
+                    if (!offA1H8(squares[i]))
+                        continue;
+                    if (offA1H8(squares[i]) > 0)
+                        for (int j = i; j < size; j++)
+                            squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+                    break;
+                }
+
+                if (table.hasUniquePieces)
+                {
+                    int adjust1 = squares[1] > squares[0];
+                    int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+
+                    if (offA1H8(squares[0]))
+                        idx = (indexTables.mapA1D1D4[squares[0]] * 63 + (squares[1] - adjust1)) * 62
+                            + squares[2] - adjust2;
+                    else if (offA1H8(squares[1]))
+                        idx = (6 * 63 + (squares[0] >> 3) * 28 + indexTables.mapB1H1H7[squares[1]]) * 62
+                            + squares[2] - adjust2;
+                    else if (offA1H8(squares[2]))
+                        idx = 6 * 63 * 62 + 4 * 28 * 62 + (squares[0] >> 3) * 7 * 28
+                            + ((squares[1] >> 3) - adjust1) * 28 + indexTables.mapB1H1H7[squares[2]];
+                    else
+                        idx = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + (squares[0] >> 3) * 7 * 6
+                            + ((squares[1] >> 3) - adjust1) * 6 + ((squares[2] >> 3) - adjust2);
+                }
+                else
+                    idx = indexTables.mapKK[indexTables.mapA1D1D4[squares[0]]][squares[1]];
+            }
+
+            // Các nhóm còn lại: tổ hợp các ô trống (bỏ ô của nhóm trước)
+            idx *= d->groupIdx[0];
+            int *groupSquares = squares + d->groupLen[0];
+            bool remainingPawns = table.hasPawns && table.pawnCount[1];
+
+            for (int next = 1; d->groupLen[next]; next++)
+            {
+                std::stable_sort(groupSquares, groupSquares + d->groupLen[next]);
+                u64 n = 0;
+                for (int i = 0; i < d->groupLen[next]; i++)
+                {
+                    int adjust = int(std::count_if(squares, groupSquares, [&](int s) { return groupSquares[i] > s; }));
+                    n += indexTables.binomial[i + 1][groupSquares[i] - adjust - 8 * remainingPawns];
+                }
+                remainingPawns = false;
+                idx += n * d->groupIdx[next];
+                groupSquares += d->groupLen[next];
+            }
+
+            return mapScore(table, file, decompressPairs(d, idx), wdl);
+        }
+
+        Table *findTable(const Board &board, bool dtz)
+        {
+            auto it = registry.byKey.find(materialKey(board, false));
+            if (it == registry.byKey.end())
+                return nullptr;
+            return dtz ? it->second.second : it->second.first;
+        }
+
+        WDLScore probeWdlTable(Board &board, ProbeState &state)
+        {
+            if (std::popcount(board.occupancy()) == 2) // KvK
+                return WDLDraw;
+            Table *table = findTable(board, false);
+            if (!table || !mapped(*table))
+            {
+                state = ProbeFail;
+                return WDLDraw;
+            }
+            return WDLScore(probeTable(board, *table, WDLDraw, state));
+        }
+
+        int probeDtzTable(Board &board, WDLScore wdl, ProbeState &state)
+        {
+            Table *table = findTable(board, true);
+            if (!table || !mapped(*table))
+            {
+                state = ProbeFail;
+                return 0;
+            }
+            return probeTable(board, *table, wdl, state);
+        }
+
+        bool hasLegalMoves(const Board &board)
+        {
+            MoveList moves;
+            generateLegalMoves(board, moves);
+            return moves.count() > 0;
+        }
+
+        bool isZeroing(const Board &board, Move move)
+        {
+            return move.isCapture() || typeOf(board.piecesList[move.from()]) == Pawn;
+        }
+
+        // Bảng không lưu thế có nước ăn quân (hoặc qua đường) là tốt nhất: xét
+        // các nước đó trước, chỉ tra bảng khi chúng chưa đủ tốt.
+        // checkZeroing: xét cả nước đi tốt (cho DTZ)
+        WDLScore searchWdl(Board &board, ProbeState &state, bool checkZeroing)
+        {
+            WDLScore value, best = WDLLoss;
+            MoveList moves;
+            generateLegalMoves(board, moves);
+            int moveCount = 0;
+
+            for (const Move &move : moves)
+            {
+                if (!move.isCapture() && (!checkZeroing || typeOf(board.piecesList[move.from()]) != Pawn))
+                    continue;
+
+                moveCount++;
+                board.doMove(move);
+                value = WDLScore(-searchWdl(board, state, false));
+                board.undoMove(move);
+
+                if (state == ProbeFail)
+                    return WDLDraw;
+
+                if (value > best)
+                {
+                    best = value;
+                    if (value >= WDLWin)
+                    {
+                        state = ProbeZeroingBest;
+                        return value;
+                    }
+                }
+            }
+
+            // Mọi nước đều đã xét (hoặc hết nước): không cần tra bảng
+            bool noMoreMoves = moveCount && moveCount == moves.count();
+            if (noMoreMoves)
+                value = best;
+            else
+            {
+                value = probeWdlTable(board, state);
+                if (state == ProbeFail)
+                    return WDLDraw;
+            }
+
+            if (best >= value)
+            {
+                state = best > WDLDraw || noMoreMoves ? ProbeZeroingBest : ProbeOk;
+                return best;
+            }
+            state = ProbeOk;
+            return value;
+        }
+
+        // DTZ của thế mà nước tốt nhất về 0 ngay
+        int dtzBeforeZeroing(WDLScore wdl)
+        {
+            return wdl == WDLWin ? 1 : wdl == WDLCursedWin ? 101 : wdl == WDLBlessedLoss ? -101 : wdl == WDLLoss ? -1 : 0;
+        }
+
+        int signOf(int value) { return (value > 0) - (value < 0); }
+
+        // Đã lặp thế nào từ lần về 0 gần nhất chưa (DTZ giả định không lặp)
+        bool hasRepeated(const Board &board)
+        {
+            const StateInfo *state = board.st;
+            int end = std::min<int>({ int(board.st->halfMove), int(board.st->pliesFromNull), int(board.ply) });
+            while (end-- >= 4)
+            {
+                if (state->repetition)
+                    return true;
+                state = state->previous;
+            }
+            return false;
+        }
+
+        bool isDrawAfterMove(const Board &board)
+        {
+            if (board.fiftyMoveRule() && (!board.inCheck() || hasLegalMoves(board)))
+                return true;
+            return board.isDrawByRepetition(1);
+        }
+
+        // Xếp hạng bằng DTZ: thắng trong giới hạn 50 nước xếp ngang nhau (search
+        // chọn), thua xếp ngang nhau trừ khi có thể kéo dài tới luật 50 nước
+        bool rootProbeDtz(Board &board, std::vector<RootMove> &moves, bool rule50)
+        {
+            ProbeState state = ProbeOk;
+            int halfMove = int(board.st->halfMove);
+            bool repeated = hasRepeated(board);
+            int bound = rule50 ? MAX_DTZ / 2 - 100 : 1;
+
+            for (RootMove &root : moves)
+            {
+                board.doMove(root.move);
+
+                int dtz;
+                if (board.st->halfMove == 0)
+                    dtz = dtzBeforeZeroing(WDLScore(-probeWdl(board, state)));
+                else if (isDrawAfterMove(board))
+                    dtz = 0;
+                else
+                {
+                    dtz = -probeDtz(board, state);
+                    dtz = dtz > 0 ? dtz + 1 : dtz < 0 ? dtz - 1 : dtz;
+                }
+
+                // Nước chiếu hết luôn có dtz 1
+                if (dtz == 2 && board.inCheck() && !hasLegalMoves(board))
+                    dtz = 1;
+
+                board.undoMove(root.move);
+                if (state == ProbeFail)
+                    return false;
+
+                int rank = dtz > 0 ? (dtz + halfMove <= 99 && !repeated ? MAX_DTZ : MAX_DTZ / 2 - (dtz + halfMove))
+                    : dtz < 0 ? (-dtz * 2 + halfMove < 100 ? -MAX_DTZ : -MAX_DTZ / 2 + (-dtz + halfMove))
+                    : 0;
+                root.rank = rank;
+
+                // Cursed win/blessed loss: ít nhất 1 cp, tăng dần khi gần thắng thật
+                root.score = rank >= bound ? VALUE_TB_WIN
+                    : rank > 0 ? (std::max(3, rank - (MAX_DTZ / 2 - 200)) * pieceValue[Pawn]) / 200
+                    : rank == 0 ? VALUE_DRAW
+                    : rank > -bound ? (std::min(-3, rank + (MAX_DTZ / 2 - 200)) * pieceValue[Pawn]) / 200
+                    : -VALUE_TB_WIN;
+            }
+            return true;
+        }
+
+        // Thiếu DTZ: chỉ phân loại thắng/hòa/thua, search phải tự tìm đường thắng
+        bool rootProbeWdl(Board &board, std::vector<RootMove> &moves, bool rule50)
+        {
+            constexpr int WdlToRank[] = { -MAX_DTZ, -MAX_DTZ + 101, 0, MAX_DTZ - 101, MAX_DTZ };
+            constexpr int WdlToValue[] = { -VALUE_TB_WIN, VALUE_DRAW - 2, VALUE_DRAW, VALUE_DRAW + 2, VALUE_TB_WIN };
+
+            ProbeState state = ProbeOk;
+            for (RootMove &root : moves)
+            {
+                board.doMove(root.move);
+                WDLScore wdl = isDrawAfterMove(board) ? WDLDraw : WDLScore(-probeWdl(board, state));
+                board.undoMove(root.move);
+                if (state == ProbeFail)
+                    return false;
+
+                root.rank = WdlToRank[wdl + 2];
+                if (!rule50)
+                    wdl = wdl > WDLDraw ? WDLWin : wdl < WDLDraw ? WDLLoss : WDLDraw;
+                root.score = WdlToValue[wdl + 2];
+            }
+            return true;
+        }
+
+        constexpr const char *WdlNames[] = { "loss", "blessed loss", "draw", "cursed win", "win" };
+
+        // ===== Bộ kiểm tra =====
+
+        constexpr int AnyDtz = 0x7FFF; // chỉ kiểm tra dấu của DTZ
+
+        struct SyzygyPosition
+        {
+            const char *fen;
+            WDLScore wdl;
+            int dtz;
+        };
+
+        // Giá trị lý thuyết chắc chắn (chiếu hết một nước, ăn quân thắng ngay,
+        // thế cờ sách giáo khoa); thế có tốt cho cả hai màu, có bảng đối xứng
+        // với cả hai bên đi
+        const SyzygyPosition syzygySuite[] = {
+            { "7k/8/6K1/8/8/8/8/Q7 w - - 0 1", WDLWin, 1 },                // KQvK, chiếu hết một nước
+            { "7k/6Q1/6K1/8/8/8/8/8 b - - 0 1", WDLLoss, -1 },             // KQvK, bị chiếu hết
+            { "8/8/8/4k3/8/8/8/KBN5 w - - 0 1", WDLWin, AnyDtz },          // KBNvK
+            { "8/8/8/4k3/8/8/8/KNN5 w - - 0 1", WDLDraw, 0 },              // KNNvK
+            { "4k3/8/4K3/4P3/8/8/8/8 w - - 0 1", WDLWin, AnyDtz },         // KPvK, vua trên ô then chốt
+            { "4k3/8/4K3/4P3/8/8/8/8 b - - 0 1", WDLLoss, AnyDtz },
+            { "8/8/8/8/4p3/4k3/8/4K3 b - - 0 1", WDLWin, AnyDtz },         // như trên, đổi màu
+            { "8/8/8/8/4p3/4k3/8/4K3 w - - 0 1", WDLLoss, AnyDtz },
+            { "4k3/4P3/4K3/8/8/8/8/8 b - - 0 1", WDLDraw, 0 },             // hết nước
+            { "k7/8/8/8/P7/8/8/K7 w - - 0 1", WDLDraw, 0 },                // tốt cột a, vua giữ góc
+            { "k7/8/8/p7/8/8/8/K7 b - - 0 1", WDLDraw, 0 },
+            { "r3k3/8/8/8/8/8/8/R3K3 w - - 0 1", WDLWin, 1 },              // KRvKR, ăn Xe
+            { "r3k3/8/8/8/8/8/8/R3K3 b - - 0 1", WDLWin, 1 },
+            { "1r6/8/3k4/8/8/3K4/8/6R1 w - - 0 1", WDLDraw, 0 },           // KRvKR, phải tra bảng
+            { "1r6/8/3k4/8/8/3K4/8/6R1 b - - 0 1", WDLDraw, 0 },
+            { "8/8/3nk3/8/8/3NK3/8/8 w - - 0 1", WDLDraw, 0 },             // KNvKN
+            { "4k3/8/8/8/8/8/r7/2Q1K3 w - - 0 1", WDLWin, AnyDtz },        // KQvKR
+            { "k7/8/1K6/8/4n3/8/8/6NR w - - 0 1", WDLWin, 1 },             // KRNvKN, chiếu hết một nước
+            { "k7/8/1K6/6p1/8/8/6P1/7R w - - 0 1", WDLWin, 1 },            // KRPvKP, chiếu hết một nước
+        };
+
+        // Kiểm tra chéo không cần đáp án: WDL cùng dấu với nước con tốt nhất,
+        // DTZ cùng dấu với WDL và nước xếp hạng cao nhất ở gốc cũng vậy
+        const char *checkConsistency(Board &board, WDLScore wdl, int dtz, bool dtzAvailable)
+        {
+            if (dtzAvailable && signOf(dtz) != signOf(wdl))
+                return "dtz sign differs from wdl";
+
+            MoveList moveList;
+            generateLegalMoves(board, moveList);
+            if (!moveList.count())
+                return nullptr;
+
+            ProbeState state;
+            int best = WDLLoss;
+            std::vector<RootMove> moves;
+            for (const Move &move : moveList)
+            {
+                board.doMove(move);
+                WDLScore value = WDLScore(-probeWdl(board, state));
+                board.undoMove(move);
+                if (state == ProbeFail)
+                    return "child probe failed";
+                best = std::max<int>(best, value);
+                moves.push_back({ move });
+            }
+            if (signOf(best) != signOf(wdl))
+                return "wdl differs from best child";
+
+            bool rootDtz;
+            if (!rankRootMoves(board, moves, true, rootDtz))
+                return "root probe failed";
+            int topRank = std::max_element(moves.begin(), moves.end(),
+                [](const RootMove &a, const RootMove &b) { return a.rank < b.rank; })->rank;
+            if (signOf(topRank) != signOf(wdl))
+                return "root ranking differs from wdl";
+            return nullptr;
+        }
+    }
+
+    int init(const std::string &paths)
+    {
+        registry.byKey.clear();
+        registry.tables.clear();
+        registry.directories.clear();
+        registry.maxPieces = 0;
+
+        if (paths.empty() || paths == "<empty>")
+            return 0;
+
+#if defined(_WIN32)
+        constexpr char Separator = ';';
+#else
+        constexpr char Separator = ':';
+#endif
+        std::stringstream stream(paths);
+        std::string directory;
+        while (std::getline(stream, directory, Separator))
+            if (!directory.empty())
+                registry.directories.push_back(directory);
+
+        constexpr int K = King;
+        for (int p1 = Pawn; p1 < K; p1++)
+        {
+            addTable({ K, p1, K });
+            for (int p2 = Pawn; p2 <= p1; p2++)
+            {
+                addTable({ K, p1, p2, K });
+                addTable({ K, p1, K, p2 });
+                for (int p3 = Pawn; p3 < K; p3++)
+                    addTable({ K, p1, p2, K, p3 });
+                for (int p3 = Pawn; p3 <= p2; p3++)
+                {
+                    addTable({ K, p1, p2, p3, K });
+                    for (int p4 = Pawn; p4 <= p3; p4++)
+                    {
+                        addTable({ K, p1, p2, p3, p4, K });
+                        for (int p5 = Pawn; p5 <= p4; p5++)
+                            addTable({ K, p1, p2, p3, p4, p5, K });
+                        for (int p5 = Pawn; p5 < K; p5++)
+                            addTable({ K, p1, p2, p3, p4, K, p5 });
+                    }
+                    for (int p4 = Pawn; p4 < K; p4++)
+                    {
+                        addTable({ K, p1, p2, p3, K, p4 });
+                        for (int p5 = Pawn; p5 <= p4; p5++)
+                            addTable({ K, p1, p2, p3, K, p4, p5 });
+                    }
+                }
+                for (int p3 = Pawn; p3 <= p1; p3++)
+                    for (int p4 = Pawn; p4 <= (p1 == p3 ? p2 : p3); p4++)
+                        addTable({ K, p1, p2, K, p3, p4 });
+            }
+        }
+        return int(registry.tables.size() / 2);
+    }
+
+    int maxPieces()
+    {
+        return registry.maxPieces;
+    }
+
+    WDLScore probeWdl(Board &board, ProbeState &state)
+    {
+        state = ProbeOk;
+        return searchWdl(board, state, false);
+    }
+
+    // Dấu theo WDL của bên đi; |dtz| = số ply tới nước về 0 (cộng 100 nếu
+    // kết quả bị luật 50 nước biến thành hòa)
+    int probeDtz(Board &board, ProbeState &state)
+    {
+        state = ProbeOk;
+        WDLScore wdl = searchWdl(board, state, true);
+
+        if (state == ProbeFail || wdl == WDLDraw)
+            return 0;
+        if (state == ProbeZeroingBest)
+            return dtzBeforeZeroing(wdl);
+
+        int dtz = probeDtzTable(board, wdl, state);
+        if (state == ProbeFail)
+            return 0;
+        if (state != ProbeChangeSide)
+            return (dtz + 100 * (wdl == WDLBlessedLoss || wdl == WDLCursedWin)) * signOf(wdl);
+
+        // Bảng lưu cho bên kia: đi từng nước rồi lấy DTZ tốt nhất cùng dấu với WDL
+        int minDtz = 0xFFFF;
+        MoveList moves;
+        generateLegalMoves(board, moves);
+        for (const Move &move : moves)
+        {
+            bool zeroing = isZeroing(board, move);
+            board.doMove(move);
+            dtz = zeroing ? -dtzBeforeZeroing(searchWdl(board, state, false)) : -probeDtz(board, state);
+
+            if (dtz == 1 && board.inCheck() && !hasLegalMoves(board))
+                minDtz = 1;
+            if (!zeroing)
+                dtz += signOf(dtz);
+            if (dtz < minDtz && signOf(dtz) == signOf(wdl))
+                minDtz = dtz;
+
+            board.undoMove(move);
+            if (state == ProbeFail)
+                return 0;
+        }
+        return minDtz == 0xFFFF ? -1 : minDtz;
+    }
+
+    bool rankRootMoves(Board &board, std::vector<RootMove> &moves, bool rule50, bool &dtzAvailable)
+    {
+        dtzAvailable = true;
+        if (rootProbeDtz(board, moves, rule50))
+            return true;
+        dtzAvailable = false;
+        if (rootProbeWdl(board, moves, rule50))
+            return true;
+        for (RootMove &root : moves)
+            root.rank = root.score = 0;
+        return false;
+    }
+
+    bool runProbe(const std::string &paths, const std::string &fen, std::ostream &out)
+    {
+        int found = init(paths);
+        out << "Found " << found << " tablebases, up to " << maxPieces() << " pieces\n";
+
+        auto board = std::make_unique<Board>(Fen(fen));
+        if (std::popcount(board->occupancy()) > maxPieces() || board->st->castling)
+        {
+            out << "Position is not covered by the tablebases\n";
+            return false;
+        }
+
+        ProbeState state;
+        WDLScore wdl = probeWdl(*board, state);
+        if (state == ProbeFail)
+        {
+            out << "WDL probe failed\n";
+            return false;
+        }
+        out << "wdl " << WdlNames[wdl + 2];
+        int dtz = probeDtz(*board, state);
+        if (state == ProbeFail)
+            out << "  dtz unavailable\n";
+        else
+            out << "  dtz " << dtz << "\n";
+
+        MoveList moveList;
+        generateLegalMoves(*board, moveList);
+        std::vector<RootMove> moves;
+        for (const Move &move : moveList)
+            moves.push_back({ move });
+        bool dtzAvailable;
+        if (!rankRootMoves(*board, moves, true, dtzAvailable))
+        {
+            out << "Root probe failed\n";
+            return false;
+        }
+        std::stable_sort(moves.begin(), moves.end(), [](const RootMove &a, const RootMove &b) { return a.rank > b.rank; });
+        out << "Root moves ranked by " << (dtzAvailable ? "DTZ" : "WDL") << ":\n";
+        for (const RootMove &root : moves)
+            out << "  " << std::left << std::setw(6) << moveToString(root.move) << std::right
+                << "  rank " << std::setw(7) << root.rank << "  score " << scoreToString(root.score) << "\n";
+        return true;
+    }
+
+    bool runSuite(const std::string &paths, std::ostream &out)
+    {
+        int found = init(paths);
+        out << "Found " << found << " tablebases, up to " << maxPieces() << " pieces\n";
+        if (!found)
+        {
+            out << "No tablebases to verify\n";
+            return false;
+        }
+
+        bool allPassed = true;
+        int index = 0, skipped = 0;
+        for (const SyzygyPosition &position : syzygySuite)
+        {
+            index++;
+            auto board = std::make_unique<Board>(Fen(position.fen));
+            out << std::setw(2) << index << "  ";
+            if (!findTable(*board, false))
+            {
+                skipped++;
+                out << "SKIP  (missing table)  " << position.fen << "\n";
+                continue;
+            }
+
+            ProbeState state;
+            WDLScore wdl = probeWdl(*board, state);
+            bool wdlProbed = state != ProbeFail;
+            int dtz = probeDtz(*board, state);
+            bool dtzProbed = state != ProbeFail;
+            // Thiếu file .rtbz thì chỉ kiểm tra WDL
+            bool dtzOk = !dtzProbed || (position.dtz == AnyDtz ? signOf(dtz) == signOf(position.wdl) : dtz == position.dtz);
+            const char *problem = wdlProbed ? checkConsistency(*board, wdl, dtz, dtzProbed) : "probe failed";
+            bool passed = wdlProbed && wdl == position.wdl && dtzOk && !problem;
+            allPassed &= passed;
+
+            out << (passed ? "OK  " : "FAIL") << "  wdl " << std::left << std::setw(12) << WdlNames[wdl + 2]
+                << "expected " << std::setw(12) << WdlNames[position.wdl + 2] << std::right << "dtz ";
+            if (dtzProbed)
+                out << std::setw(4) << dtz;
+            else
+                out << " n/a";
+            if (position.dtz != AnyDtz)
+                out << "  expected " << std::setw(4) << position.dtz;
+            if (problem)
+                out << "  (" << problem << ")";
+            out << "  " << position.fen << "\n";
+        }
+        if (skipped)
+            out << skipped << " positions skipped\n";
+        out << (allPassed ? "All positions passed\n" : "Some positions FAILED\n");
+        return allPassed;
+    }
+}
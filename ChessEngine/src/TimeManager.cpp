@@ -0,0 +1,74 @@
+#include "TimeManager.h"
+#include "Search.h"
+#include <algorithm>
+
+namespace ChessEngine
+{
+    namespace
+    {
+        // Số nước giả định còn lại khi GUI không gửi movestogo (sudden death)
+        constexpr int DefaultMovesToGo = 40;
+
+        // Nước tốt nhất càng ổn định qua các vòng thì càng dừng sớm
+        constexpr double StabilityScale[] = { 1.40, 1.10, 0.95, 0.85, 0.80, 0.75 };
+    }
+
+    void TimeManager::init(const SearchLimits &limits, ui us)
+    {
+        active = false;
+        fixedTime = false;
+        stability = 0;
+        hasPreviousScore = false;
+
+        if (limits.moveTime > 0)
+        {
+            active = fixedTime = true;
+            optimumMs = maximumMs = std::max(1, limits.moveTime - limits.moveOverhead);
+            return;
+        }
+
+        if (limits.time[us] <= 0)
+            return;
+
+        active = true;
+        int remaining = std::max(1, limits.time[us] - limits.moveOverhead);
+        int inc = limits.inc[us];
+        int movesToGo = limits.movesToGo > 0 ? std::min(limits.movesToGo, DefaultMovesToGo) : DefaultMovesToGo;
+
+        // Phần chia đều cộng gần hết increment; không bao giờ dùng quá một
+        // phần của thời gian còn lại, nhất là khi sắp tới lần kiểm soát
+        int base = remaining / movesToGo + inc * 3 / 4;
+        double hardShare = movesToGo == 1 ? 0.90 : 0.75;
+        maximumMs = std::max(1, std::min((int)(remaining * hardShare), base * 5));
+        optimumMs = std::max(1, std::min(base, maximumMs));
+    }
+
+    bool TimeManager::stopAfterIteration(int elapsedMs, bool bestMoveChanged, int score, double bestMoveNodeFraction)
+    {
+        if (!active)
+            return false;
+        if (fixedTime)
+            return elapsedMs >= maximumMs;
+
+        stability = bestMoveChanged ? 0 : std::min(stability + 1, 5);
+
+        // Điểm tụt so với vòng trước: cần thêm thời gian để tìm cách cứu
+        double scoreScale = 1.0;
+        if (hasPreviousScore)
+        {
+            int drop = previousScore - score;
+            if (drop > 0)
+                scoreScale = 1.0 + std::min(drop, 80) / 160.0;
+            else if (drop < -30)
+                scoreScale = 0.9;
+        }
+        previousScore = score;
+        hasPreviousScore = true;
+
+        // Phần lớn nút dồn cho nước tốt nhất: ít đối thủ cạnh tranh, dừng sớm
+        double nodeScale = (1.6 - bestMoveNodeFraction) * 1.2;
+
+        double scaled = optimumMs * StabilityScale[stability] * scoreScale * nodeScale;
+        return elapsedMs >= std::min(scaled, (double)maximumMs);
+    }
+}
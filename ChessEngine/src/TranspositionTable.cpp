@@ -0,0 +1,205 @@
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <climits>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#elif defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace ChessEngine
+{
+    TranspositionTable TT; // Bảng dùng chung cho mọi luồng tìm kiếm
+
+    namespace
+    {
+        constexpr size_t HugePageSize = 2 * 1024 * 1024;
+
+        // Layout 64 bit: key16 | move16 | score16 | depth8 | bound2 | age6
+        inline u64 packEntry(uint16_t key16, uint16_t move, int score, int depth, ui bound, ui age)
+        {
+            return u64(key16)
+                | (u64(move) << 16)
+                | (u64(uint16_t(int16_t(score))) << 32)
+                | (u64(uint8_t(depth)) << 48)
+                | (u64(bound & 3) << 56)
+                | (u64(age & 63) << 58);
+        }
+
+        inline uint16_t keyOf(u64 entry) { return uint16_t(entry); }
+        inline uint16_t moveOf(u64 entry) { return uint16_t(entry >> 16); }
+        inline int scoreOf(u64 entry) { return int16_t(uint16_t(entry >> 32)); }
+        inline int rawDepthOf(u64 entry) { return int(uint8_t(entry >> 48)); }
+        inline ui boundOf(u64 entry) { return ui(entry >> 56) & 3; }
+        inline ui ageOf(u64 entry) { return ui(entry >> 58) & 63; }
+
+        void *allocateLarge(size_t bytes)
+        {
+#if defined(__linux__)
+            // Căn theo 2MB để kernel có thể dùng transparent huge pages,
+            // giảm TLB miss khi truy cập ngẫu nhiên vào bảng lớn
+            size_t rounded = (bytes + HugePageSize - 1) / HugePageSize * HugePageSize;
+            void *memory = std::aligned_alloc(HugePageSize, rounded);
+            if (memory)
+                madvise(memory, rounded, MADV_HUGEPAGE);
+            return memory;
+#elif defined(_WIN32)
+            return _aligned_malloc(bytes, 64);
+#else
+            return std::aligned_alloc(64, (bytes + 63) / 64 * 64);
+#endif
+        }
+
+        void freeLarge(void *memory)
+        {
+#if defined(_WIN32)
+            _aligned_free(memory);
+#else
+            std::free(memory);
+#endif
+        }
+    }
+
+    TranspositionTable::TranspositionTable()
+    {
+        resize(16);
+    }
+
+    TranspositionTable::~TranspositionTable()
+    {
+        release();
+    }
+
+    void TranspositionTable::release()
+    {
+        if (buckets)
+        {
+            for (size_t i = 0; i < bucketCount; i++)
+                buckets[i].~Bucket();
+            freeLarge(buckets);
+        }
+        buckets = nullptr;
+        bucketCount = 0;
+    }
+
+    void TranspositionTable::resize(size_t mb)
+    {
+        release();
+
+        // Số bucket là lũy thừa của 2 để lấy index bằng phép AND
+        size_t count = std::max<size_t>(1, mb * 1024 * 1024 / sizeof(Bucket));
+        count = std::bit_floor(count);
+
+        void *memory = allocateLarge(count * sizeof(Bucket));
+        if (!memory)
+            throw std::bad_alloc();
+
+        buckets = static_cast<Bucket *>(memory);
+        bucketCount = count;
+        megabytes = mb;
+        for (size_t i = 0; i < bucketCount; i++)
+            new (&buckets[i]) Bucket();
+        clear();
+    }
+
+    void TranspositionTable::clear()
+    {
+        for (size_t i = 0; i < bucketCount; i++)
+            for (std::atomic<u64> &entry : buckets[i].entries)
+                entry.store(0, std::memory_order_relaxed);
+        age = 0;
+    }
+
+    void TranspositionTable::newSearch()
+    {
+        age = (age + 1) & AgeMask;
+    }
+
+    TranspositionTable::Bucket *TranspositionTable::bucketFor(u64 key) const
+    {
+        // 16 bit thấp làm key kiểm tra, các bit phía trên chọn bucket
+        return &buckets[(key >> 16) & (bucketCount - 1)];
+    }
+
+    bool TranspositionTable::probe(u64 key, TTData &data) const
+    {
+        const Bucket *bucket = bucketFor(key);
+        uint16_t key16 = uint16_t(key);
+
+        for (const std::atomic<u64> &slot : bucket->entries)
+        {
+            u64 entry = slot.load(std::memory_order_relaxed);
+            if (keyOf(entry) == key16 && boundOf(entry) != BoundNone)
+            {
+                data.move = moveOf(entry);
+                data.score = scoreOf(entry);
+                data.depth = rawDepthOf(entry) - DepthOffset;
+                data.bound = Bound(boundOf(entry));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void TranspositionTable::store(u64 key, uint16_t move, int score, int depth, Bound bound)
+    {
+        Bucket *bucket = bucketFor(key);
+        uint16_t key16 = uint16_t(key);
+        int rawDepth = std::clamp(depth + DepthOffset, 0, 255);
+
+        std::atomic<u64> *victim = &bucket->entries[0];
+        int worstValue = INT_MAX;
+
+        for (std::atomic<u64> &slot : bucket->entries)
+        {
+            u64 entry = slot.load(std::memory_order_relaxed);
+
+            if (boundOf(entry) == BoundNone)
+            {
+                victim = &slot;
+                break;
+            }
+
+            if (keyOf(entry) == key16)
+            {
+                // Cùng vị trí: giữ nước cũ nếu chưa có nước mới, và không để
+                // kết quả nông ghi đè kết quả sâu hơn nhiều của cùng lần tìm
+                if (move == 0)
+                    move = moveOf(entry);
+                if (bound != BoundExact && ageOf(entry) == age && rawDepth + 4 < rawDepthOf(entry))
+                    return;
+                victim = &slot;
+                break;
+            }
+
+            // Thay entry nông nhất và cũ nhất
+            int relativeAge = int((age - ageOf(entry)) & AgeMask);
+            int value = rawDepthOf(entry) - 8 * relativeAge;
+            if (value < worstValue)
+            {
+                worstValue = value;
+                victim = &slot;
+            }
+        }
+
+        victim->store(packEntry(key16, move, score, rawDepth, bound, age), std::memory_order_relaxed);
+    }
+
+    int TranspositionTable::hashfull() const
+    {
+        size_t sampleBuckets = std::min<size_t>(bucketCount, 1000 / EntriesPerBucket);
+        int used = 0;
+        for (size_t i = 0; i < sampleBuckets; i++)
+        {
+            for (const std::atomic<u64> &slot : buckets[i].entries)
+            {
+                u64 entry = slot.load(std::memory_order_relaxed);
+                if (boundOf(entry) != BoundNone && ageOf(entry) == age)
+                    used++;
+            }
+        }
+        return int(used * 1000 / (sampleBuckets * EntriesPerBucket));
+    }
+}
@@ -0,0 +1,433 @@
+#include "UCI.h"
+#include "Board.h"
+#include "Search.h"
+#include "MoveGenerator.h"
+#include "TranspositionTable.h"
+#include "NNUE.h"
+#include "Syzygy.h"
+#include "Book.h"
+#include <sstream>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace ChessEngine;
+
+namespace UCI
+{
+    namespace
+    {
+        const char *StartFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+        // Luồng tìm kiếm và luồng đọc lệnh cùng ghi stdout
+        std::mutex outputMutex;
+
+        void send(const std::string &line)
+        {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cout << line << std::endl;
+        }
+
+        // Giá trị option "spin" do GUI gửi: ngoài [min, max] thì kẹp lại, không
+        // phải số nguyên thì báo lỗi và giữ nguyên giá trị cũ (không ném ngoại lệ)
+        bool parseSpin(const std::string &name, const std::string &value, int min, int max, int &result)
+        {
+            int parsed = 0;
+            const char *last = value.data() + value.size();
+            auto [end, error] = std::from_chars(value.data(), last, parsed);
+            if (error == std::errc::result_out_of_range)
+                parsed = value[0] == '-' ? min : max;
+            else if (error != std::errc() || end != last)
+            {
+                send("info string invalid value '" + value + "' for option " + name);
+                return false;
+            }
+            result = std::clamp(parsed, min, max);
+            return true;
+        }
+
+        class Engine
+        {
+        public:
+            Engine() : board(std::make_unique<Board>(Fen(StartFen))) {}
+            ~Engine() { stopSearch(); }
+
+            void uci();
+            void setOption(std::istringstream &input);
+            void newGame();
+            void position(std::istringstream &input);
+            void go(std::istringstream &input);
+            void ponderhit();
+            void stopSearch();
+            void display() const { board->printBoard(); }
+
+        private:
+            void releaseBestMove();
+
+            std::unique_ptr<Board> board; // ~80KB, không để trên stack
+            SearchPool pool;
+            std::thread searchThread;
+
+            // "go infinite"/"go ponder": luồng tìm kiếm giữ bestmove tới khi
+            // nhận "stop" hoặc "ponderhit", kể cả khi đã tìm xong
+            std::mutex waitMutex;
+            std::condition_variable waitCondition;
+            bool holdBestMove = false;
+
+            int moveOverhead = 10;
+            SearchFeatures features;
+            int syzygyProbeLimit = Syzygy::MAX_PIECES;
+            int syzygyProbeDepth = 1;
+            bool syzygy50MoveRule = true;
+
+            // Sách khai cuộc: chỉ dùng khi OwnBook bật và số nước của ván <= bookDepth
+            PolyglotBook book;
+            bool ownBook = false;
+            bool bookBestMove = false;
+            int bookDepth = 255;
+            std::mt19937_64 bookRng{ std::random_device{}() };
+        };
+
+        void Engine::uci()
+        {
+            send("id name ChessEngine");
+            send("id author iza0122");
+            send("option name Hash type spin default 16 min 1 max 65536");
+            send("option name Threads type spin default 1 min 1 max 256");
+            send("option name Clear Hash type button");
+            send("option name Ponder type check default false");
+            send("option name Move Overhead type spin default 10 min 0 max 5000");
+            send("option name EvalFile type string default <empty>");
+            send("option name SyzygyPath type string default <empty>");
+            send("option name SyzygyProbeDepth type spin default 1 min 1 max 100");
+            send("option name SyzygyProbeLimit type spin default 7 min 0 max 7");
+            send("option name Syzygy50MoveRule type check default true");
+            send("option name OwnBook type check default false");
+            send("option name BookFile type string default <empty>");
+            send("option name BookBestMove type check default false");
+            send("option name BookDepth type spin default 255 min 1 max 255");
+            for (const SearchFeatureOption &option : searchFeatureOptions())
+                send(std::string("option name ") + option.name + " type check default true");
+            send("uciok");
+        }
+
+        void Engine::setOption(std::istringstream &input)
+        {
+            std::string token, name, value;
+            input >> token; // "name"
+            while (input >> token && token != "value")
+                name += (name.empty() ? "" : " ") + token;
+            while (input >> token)
+                value += (value.empty() ? "" : " ") + token;
+
+            stopSearch();
+            int spin = 0;
+            if (name == "Hash")
+            {
+                if (parseSpin(name, value, 1, 65536, spin))
+                    TT.resize(spin);
+            }
+            else if (name == "Threads")
+            {
+                if (parseSpin(name, value, 1, 256, spin))
+                    pool.setThreads(spin);
+            }
+            else if (name == "Move Overhead")
+                parseSpin(name, value, 0, 5000, moveOverhead);
+            else if (name == "Clear Hash")
+                TT.clear();
+            else if (name == "EvalFile")
+            {
+                if (value.empty() || value == "<empty>")
+                    NNUE::unload();
+                else if (NNUE::load(value))
+                    send(std::string("info string loaded ") + value + " (" + NNUE::backendName(NNUE::currentBackend()) + ")");
+                else
+                    send("info string cannot load " + value);
+            }
+            else if (name == "SyzygyPath")
+            {
+                int found = Syzygy::init(value);
+                if (found)
+                    send("info string found " + std::to_string(found) + " tablebases, up to "
+                        + std::to_string(Syzygy::maxPieces()) + " pieces");
+                else if (!value.empty() && value != "<empty>")
+                    send("info string no tablebases found in " + value);
+            }
+            else if (name == "SyzygyProbeDepth")
+                parseSpin(name, value, 1, 100, syzygyProbeDepth);
+            else if (name == "SyzygyProbeLimit")
+                parseSpin(name, value, 0, Syzygy::MAX_PIECES, syzygyProbeLimit);
+            else if (name == "Syzygy50MoveRule")
+                syzygy50MoveRule = value == "true";
+            else if (name == "OwnBook")
+                ownBook = value == "true";
+            else if (name == "BookFile")
+            {
+                if (value.empty() || value == "<empty>")
+                    book.close();
+                else if (book.open(value))
+                    send("info string loaded book " + value + " (" + std::to_string(book.entryCount()) + " entries)");
+                else
+                    send("info string cannot load book " + value);
+            }
+            else if (name == "BookBestMove")
+                bookBestMove = value == "true";
+            else if (name == "BookDepth")
+                parseSpin(name, value, 1, 255, bookDepth);
+            else if (name == "Ponder")
+                return;
+            else
+            {
+                for (const SearchFeatureOption &option : searchFeatureOptions())
+                    if (name == option.name)
+                    {
+                        features.*option.flag = value == "true";
+                        return;
+                    }
+                send("info string unknown option " + name);
+            }
+        }
+
+        void Engine::newGame()
+        {
+            stopSearch();
+            TT.clear();
+            pool.clear();
+        }
+
+        // position startpos|fen <fen> [moves m1 m2 ...]; nước đi được áp dụng
+        // bằng doMove nên lịch sử lặp nước được giữ cho search
+        void Engine::position(std::istringstream &input)
+        {
+            stopSearch();
+
+            std::string token, fen;
+            input >> token;
+            if (token == "startpos")
+            {
+                fen = StartFen;
+                input >> token; // "moves" nếu có
+            }
+            else if (token == "fen")
+            {
+                while (input >> token && token != "moves")
+                    fen += token + " ";
+            }
+            else
+                return;
+
+            board = std::make_unique<Board>(Fen(fen));
+            while (input >> token)
+            {
+                Move move = parseMove(*board, token);
+                if (move.isNone())
+                {
+                    send("info string illegal move " + token);
+                    break;
+                }
+                if (board->ply >= MAX_PLY - 1)
+                    board->trimHistory();
+                board->doMove(move);
+            }
+            // Chừa chỗ trong stateStack cho độ sâu tìm kiếm tối đa
+            if (board->ply + MAX_SEARCH_PLY >= MAX_PLY)
+                board->trimHistory();
+        }
+
+        void Engine::go(std::istringstream &input)
+        {
+            stopSearch();
+
+            SearchLimits limits;
+            limits.moveOverhead = moveOverhead;
+            limits.features = features;
+            limits.syzygyProbeLimit = syzygyProbeLimit;
+            limits.syzygyProbeDepth = syzygyProbeDepth;
+            limits.syzygy50MoveRule = syzygy50MoveRule;
+            std::string token;
+            while (input >> token)
+            {
+                if (token == "depth") input >> limits.depth;
+                else if (token == "nodes") input >> limits.nodes;
+                else if (token == "movetime") input >> limits.moveTime;
+                else if (token == "wtime") input >> limits.time[White];
+                else if (token == "btime") input >> limits.time[Black];
+                else if (token == "winc") input >> limits.inc[White];
+                else if (token == "binc") input >> limits.inc[Black];
+                else if (token == "movestogo") input >> limits.movesToGo;
+                else if (token == "infinite") limits.infinite = true;
+                else if (token == "ponder") limits.ponder = true;
+            }
+
+            // Nước sách trả lời ngay, không tìm kiếm (trừ khi phân tích vô hạn/ponder)
+            if (ownBook && book.isOpen() && !limits.infinite && !limits.ponder
+                && board->st->fullMove <= (ui)bookDepth)
+            {
+                Move move = book.probe(*board, bookBestMove, bookRng);
+                if (!move.isNone())
+                {
+                    send("info string book move " + moveToString(move));
+                    send("bestmove " + moveToString(move));
+                    return;
+                }
+            }
+
+            holdBestMove = limits.infinite || limits.ponder;
+            pool.resetStop();
+            searchThread = std::thread([this, limits]
+            {
+                SearchInfo info = pool.think(*board, limits, [](const SearchInfo &iteration)
+                {
+                    std::ostringstream line;
+                    printSearchInfo(iteration, line);
+                    std::string text = line.str();
+                    send(text.substr(0, text.size() - 1));
+                });
+
+                {
+                    std::unique_lock<std::mutex> lock(waitMutex);
+                    waitCondition.wait(lock, [this] { return !holdBestMove; });
+                }
+
+                std::string bestMove = "bestmove " + moveToString(info.bestMove);
+                if (info.pv.size() >= 2)
+                    bestMove += " ponder " + moveToString(info.pv[1]);
+                send(bestMove);
+            });
+        }
+
+        void Engine::releaseBestMove()
+        {
+            {
+                std::lock_guard<std::mutex> lock(waitMutex);
+                holdBestMove = false;
+            }
+            waitCondition.notify_all();
+        }
+
+        // Đối thủ đi đúng nước đang suy nghĩ trước: tiếp tục với giới hạn thời gian thường
+        void Engine::ponderhit()
+        {
+            pool.ponderhit();
+            releaseBestMove();
+        }
+
+        void Engine::stopSearch()
+        {
+            if (!searchThread.joinable())
+                return;
+            pool.stop();
+            releaseBestMove();
+            searchThread.join();
+        }
+
+        Engine &engine()
+        {
+            static Engine instance;
+            return instance;
+        }
+    }
+
+    bool execute(const std::string &line)
+    {
+        std::istringstream input(line);
+        std::string command;
+        if (!(input >> command))
+            return true;
+
+        Engine &e = engine();
+        if (command == "uci") e.uci();
+        else if (command == "isready") send("readyok");
+        else if (command == "setoption") e.setOption(input);
+        else if (command == "ucinewgame") e.newGame();
+        else if (command == "position") e.position(input);
+        else if (command == "go") e.go(input);
+        else if (command == "stop") e.stopSearch();
+        else if (command == "ponderhit") e.ponderhit();
+        else if (command == "d") e.display();
+        else if (command == "quit")
+        {
+            e.stopSearch();
+            return false;
+        }
+        else
+            send("info string unknown command " + command);
+        return true;
+    }
+
+    void loop()
+    {
+        std::string line;
+        while (std::getline(std::cin, line))
+            if (!execute(line))
+                return;
+        engine().stopSearch();
+    }
+
+    bool runStopTest(std::ostream &out)
+    {
+        constexpr int Rounds = 200;
+        constexpr int MaxLatencyMs = 50;
+        constexpr int TimeoutMs = 10000;
+
+        // Thu bestmove/info của engine thay vì in ra màn hình
+        std::ostringstream captured;
+        std::streambuf *original;
+        {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            original = std::cout.rdbuf(captured.rdbuf());
+        }
+
+        // stop bị mất thì join() không bao giờ trả về: luồng canh báo lỗi rồi thoát
+        std::mutex doneMutex;
+        std::condition_variable doneCondition;
+        bool done = false;
+        std::thread watchdog([&]
+        {
+            std::unique_lock<std::mutex> lock(doneMutex);
+            if (doneCondition.wait_for(lock, std::chrono::milliseconds(TimeoutMs), [&] { return done; }))
+                return;
+            std::cout.rdbuf(original);
+            out << "FAIL  search still running " << TimeoutMs << "ms after stop\n" << std::flush;
+            std::_Exit(1);
+        });
+
+        double maxLatency = 0;
+        execute("position startpos");
+        for (int round = 0; round < Rounds; round++)
+        {
+            execute(round % 2 ? "go ponder" : "go infinite");
+            auto start = std::chrono::steady_clock::now();
+            execute("stop");
+            maxLatency = std::max(maxLatency,
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            done = true;
+        }
+        doneCondition.notify_all();
+        watchdog.join();
+        {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cout.rdbuf(original);
+        }
+
+        int bestMoves = 0;
+        std::istringstream lines(captured.str());
+        std::string line;
+        while (std::getline(lines, line))
+            bestMoves += line.rfind("bestmove ", 0) == 0;
+
+        bool passed = bestMoves == Rounds && maxLatency <= MaxLatencyMs;
+        out << (passed ? "OK  " : "FAIL") << "  " << Rounds << " x go/stop  bestmove " << bestMoves << "/" << Rounds
+            << "  max stop latency " << maxLatency << "ms (limit " << MaxLatencyMs << "ms)\n";
+        return passed;
+    }
+}
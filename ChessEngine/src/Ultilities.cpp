@@ -76,6 +76,11 @@ namespace ChessEngine {
 		return rank * 8 + file;
 	}
 
+	std::string squareToString(ui square) {
+		if (square >= 64) return "-";
+		return { char('a' + square % 8), char('1' + square / 8) };
+	}
+
 	ui promotePiece(const ui &pawn,const ui &promo)
 	{
 		bool isWhite = pawn <= WhiteKing;
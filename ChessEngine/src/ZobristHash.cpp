@@ -1,7 +1,9 @@
 ﻿#include "ZobristHash.h"
+#include "AttackTable.h"
 
 namespace ChessEngine{
 	Zobrist zobrist; //Khởi tạo duy nhất 
+	Cuckoo cuckoo;   // khai báo sau zobrist: khởi tạo theo thứ tự trong cùng file
 }
 
 ChessEngine::Zobrist::Zobrist()
@@ -17,7 +19,7 @@ ChessEngine::Zobrist::Zobrist()
 
 	sideToMove = dist(rng);
 
-	for (int i = 0; i < 4; i++) {
+	for (int i = 0; i < 16; i++) {
 		castlingRight[i] = dist(rng);
 	}
 
@@ -26,3 +28,39 @@ ChessEngine::Zobrist::Zobrist()
 	}
 }
 
+
+ChessEngine::Cuckoo::Cuckoo()
+	: keys{}, moves{}, count(0)
+{
+	for (ui piece = WhitePawn; piece <= BlackKing; piece++) {
+		ui type = typeOf(piece);
+		if (type == Pawn)
+			continue;
+
+		for (ui s1 = 0; s1 < 64; s1++) {
+			u64 targets = type == Knight ? Attack.knightAttack[s1]
+				: type == Bishop ? bishopAttacks(s1, 0)
+				: type == Rook ? rookAttacks(s1, 0)
+				: type == Queen ? queenAttacks(s1, 0)
+				: Attack.kingAttack[s1];
+
+			for (ui s2 = s1 + 1; s2 < 64; s2++) {
+				if (!(targets & squareBB(s2)))
+					continue;
+
+				// Chèn kiểu cuckoo: đẩy entry đang chiếm chỗ sang vị trí còn lại của nó
+				uint16_t move = uint16_t(s1 | s2 << 6);
+				u64 key = zobrist.pieces[piece][s1] ^ zobrist.pieces[piece][s2] ^ zobrist.sideToMove;
+				ui i = h1(key);
+				while (true) {
+					std::swap(keys[i], key);
+					std::swap(moves[i], move);
+					if (move == 0)
+						break;
+					i = i == h1(key) ? h2(key) : h1(key);
+				}
+				count++;
+			}
+		}
+	}
+}